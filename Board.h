@@ -0,0 +1,125 @@
+#pragma once
+#include "Level.h"
+
+//Terrain, item and state flags of every cell of a level in play, packed side by side in chunks
+//so a cell is read from one place, the chunks only cover where the level or its item map is painted
+class Board {
+public:
+	enum Flag : uint8_t {
+		ToggleTile = 1, //A toggle tile lies in the cell
+		FilledHole = 2, //The cell was a hole until a box filled it
+		PickedItem = 4	//The cell's item was picked up
+	};
+
+	struct Square {
+		char terrain, item;
+		uint8_t flags;
+	};
+private:
+	ChunkedGrid<Square> squares;
+	uint32_t width, height;
+
+	std::vector<std::pair<int, int>> changes; //Cells whose terrain or item changed since the last ClearChanges
+	bool isChangeKept;
+
+	void KeepChange(int x, int y) {
+		if (isChangeKept) changes.emplace_back(x, y);
+	}
+
+	inline bool IsInside(int x, int y) const { return x >= 0 && y >= 0 && (uint32_t)x < width && (uint32_t)y < height; }
+	inline Square& At(int x, int y) { return squares.At(x, y); }
+	inline const Square& At(int x, int y) const { return squares.Get(x, y); }
+
+	//Does every cell of the chunk at (x, y) lie in the map and hold its background
+	static bool IsBackground(const Level& map, uint32_t x, uint32_t y) {
+		const uint32_t n = ChunkedGrid<Square>::chunkSize;
+		return x + n <= map.GetWidth() && y + n <= map.GetHeight() && !map.GetCells().GetIsPainted(x, y);
+	}
+public:
+	Board() {
+		width = height = 0;
+		isChangeKept = false;
+	}
+
+	//Packs a level's terrain & item map, the board covers both
+	//Chunks that are background in both stay unallocated & read as the two backgrounds together
+	void Load(const Level& level, const ItemMap& itemMap) {
+		width = std::max(level.GetWidth(), itemMap.GetWidth());
+		height = std::max(level.GetHeight(), itemMap.GetHeight());
+
+		squares.Reset(width, height, { level.GetCells().GetFill(), itemMap.GetCells().GetFill(), 0 });
+		changes.clear();
+
+		const uint32_t n = ChunkedGrid<Square>::chunkSize;
+		for (uint32_t y = 0; y < height; y += n) {
+			for (uint32_t x = 0; x < width; x += n) {
+				if (IsBackground(level, x, y) && IsBackground(itemMap, x, y)) continue;
+
+				for (uint32_t i = y; i < std::min(y + n, height); i++) {
+					for (uint32_t j = x; j < std::min(x + n, width); j++) {
+						At(j, i) = { level.GetCharacter(j, i), itemMap.GetCharacter(j, i), 0 };
+					}
+				}
+			}
+		}
+	}
+
+	inline char GetTerrain(int x, int y) const { return IsInside(x, y) ? At(x, y).terrain : '\0'; }
+	inline char GetItem(int x, int y) const { return IsInside(x, y) ? At(x, y).item : '\0'; }
+	inline bool GetFlag(int x, int y, Flag flag) const { return IsInside(x, y) && (At(x, y).flags & flag) != 0; }
+
+	void SetItem(int x, int y, char c) {
+		if (!IsInside(x, y)) return;
+		At(x, y).item = c;
+		KeepChange(x, y);
+	}
+
+	void SetFlag(int x, int y, Flag flag) {
+		if (IsInside(x, y)) At(x, y).flags |= flag;
+	}
+
+	//A box falls into a hole and the cell becomes floor
+	void FillHole(int x, int y) {
+		if (!IsInside(x, y)) return;
+		At(x, y).terrain = '#';
+		At(x, y).flags |= FilledHole;
+		KeepChange(x, y);
+	}
+
+	void OpenHole(int x, int y) {
+		if (!IsInside(x, y)) return;
+		At(x, y).terrain = '.';
+		At(x, y).flags &= ~FilledHole;
+		KeepChange(x, y);
+	}
+
+	void PickItem(int x, int y) {
+		if (!IsInside(x, y)) return;
+		At(x, y).item = '#';
+		At(x, y).flags |= PickedItem;
+		KeepChange(x, y);
+	}
+
+	void DropItem(int x, int y, char item) {
+		if (!IsInside(x, y)) return;
+		At(x, y).item = item;
+		At(x, y).flags &= ~PickedItem;
+		KeepChange(x, y);
+	}
+
+	//A renderer patching only changed cells turns this on, searches replaying many moves leave it off
+	void SetIsChangeKept(bool state) {
+		isChangeKept = state;
+		changes.clear();
+	}
+
+	void ClearChanges() { changes.clear(); }
+
+	//Squares from (x, y) to the end of its chunk's row, in place, n is set to how many there are
+	inline const Square* GetRun(uint32_t x, uint32_t y, uint32_t& n) const { return squares.GetRun(x, y, n); }
+	inline const std::vector<std::pair<int, int>>& GetChanges() const { return changes; }
+	inline std::size_t GetMemoryUse() const { return squares.GetMemoryUse(); }
+
+	inline uint32_t GetWidth() const { return width; }
+	inline uint32_t GetHeight() const { return height; }
+};
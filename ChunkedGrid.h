@@ -0,0 +1,80 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+//Grid of cells split into square chunks of chunkSize x chunkSize cells, a chunk is only allocated once a cell in it
+//is written with something other than the fill value, so memory follows the painted area and not the grid's size
+//A lookup is a directory read and an index into the chunk, the caller keeps coordinates inside the grid
+template<typename T, uint32_t chunkShift = 6>
+class ChunkedGrid {
+public:
+	static const uint32_t chunkSize = 1u << chunkShift;
+private:
+	static const uint32_t chunkMask = chunkSize - 1;
+
+	std::vector<int32_t> directory;	   //Chunk of each block of cells, -1 -> every cell in it holds fill
+	std::vector<std::vector<T>> chunks; //Cells of a chunk stored row after row
+	std::vector<T> fillRow;			   //A chunk row of fill, read in place of rows of chunks never written
+	T fill;
+	uint32_t width, height, nChunksX;
+
+	inline std::size_t GetChunk(uint32_t x, uint32_t y) const { return (std::size_t)(y >> chunkShift) * nChunksX + (x >> chunkShift); }
+	inline static std::size_t GetOffset(uint32_t x, uint32_t y) { return (std::size_t)((y & chunkMask) << chunkShift | (x & chunkMask)); }
+public:
+	ChunkedGrid() {
+		fill = T();
+		width = height = nChunksX = 0;
+	}
+
+	//Drops every chunk and sizes the grid, all its cells read as newFill
+	void Reset(uint32_t newWidth, uint32_t newHeight, const T& newFill) {
+		width = newWidth;
+		height = newHeight;
+		fill = newFill;
+
+		nChunksX = (width + chunkMask) >> chunkShift;
+		uint32_t nChunksY = (height + chunkMask) >> chunkShift;
+
+		directory.assign((std::size_t)nChunksX * nChunksY, -1);
+		chunks.clear();
+		fillRow.assign(chunkSize, fill);
+	}
+
+	inline const T& Get(uint32_t x, uint32_t y) const {
+		int32_t chunk = directory[GetChunk(x, y)];
+		return chunk < 0 ? fill : chunks[chunk][GetOffset(x, y)];
+	}
+
+	//Writable cell, its chunk is allocated on first use
+	T& At(uint32_t x, uint32_t y) {
+		int32_t& chunk = directory[GetChunk(x, y)];
+		if (chunk < 0) {
+			chunk = (int32_t)chunks.size();
+			chunks.emplace_back((std::size_t)chunkSize * chunkSize, fill);
+		}
+		return chunks[chunk][GetOffset(x, y)];
+	}
+
+	//Writing fill into a chunk never written leaves it unallocated
+	void Set(uint32_t x, uint32_t y, const T& value) {
+		if (directory[GetChunk(x, y)] < 0 && value == fill) return;
+		At(x, y) = value;
+	}
+
+	//Cells from (x, y) to the end of its chunk's row, in place, n is set to how many there are
+	const T* GetRun(uint32_t x, uint32_t y, uint32_t& n) const {
+		n = chunkSize - (x & chunkMask);
+		int32_t chunk = directory[GetChunk(x, y)];
+		return chunk < 0 ? fillRow.data() : chunks[chunk].data() + GetOffset(x, y);
+	}
+
+	//Was any cell of the chunk holding (x, y) written
+	inline bool GetIsPainted(uint32_t x, uint32_t y) const { return directory[GetChunk(x, y)] >= 0; }
+
+	inline const T& GetFill() const { return fill; }
+	inline std::size_t GetChunkCount() const { return chunks.size(); }
+	inline std::size_t GetMemoryUse() const { return directory.size() * sizeof(int32_t) + chunks.size() * chunkSize * chunkSize * sizeof(T); }
+	inline uint32_t GetWidth() const { return width; }
+	inline uint32_t GetHeight() const { return height; }
+};
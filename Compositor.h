@@ -0,0 +1,48 @@
+#pragma once
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/Graphics/Sprite.hpp>
+#include <functional>
+#include <vector>
+
+//Layers of a scene that rarely change drawn once into an off-screen texture, each frame then draws that texture
+//as a single quad, the layers are drawn again in order only after one of them was invalidated
+class Compositor {
+private:
+	sf::RenderTexture texture;
+	sf::Sprite sprite;
+	std::vector<std::function<void(sf::RenderTarget&)>> layers;
+	bool isValid;
+public:
+	Compositor() {
+		isValid = false;
+	}
+
+	void Create(const sf::Vector2u& size) {
+		texture.create(size.x, size.y);
+		sprite.setTexture(texture.getTexture(), true);
+		isValid = false;
+	}
+
+	//Layers are drawn in the order they were added, later ones on top
+	void AddLayer(std::function<void(sf::RenderTarget&)> draw) {
+		layers.push_back(std::move(draw));
+		isValid = false;
+	}
+
+	//Something a layer draws changed, such as a new level, an edit or a filled hole
+	void Invalidate() { isValid = false; }
+
+	void Render(sf::RenderTarget& target) {
+		if (!isValid) {
+			texture.clear(sf::Color::Transparent);
+			for (const auto& draw : layers) draw(texture);
+			texture.display();
+			isValid = true;
+		}
+
+		//Translucent layers were already blended into the texture, so its colors carry their alpha & are not multiplied again
+		target.draw(sprite, sf::RenderStates(sf::BlendMode(sf::BlendMode::One, sf::BlendMode::OneMinusSrcAlpha)));
+	}
+
+	inline bool GetIsValid() const { return isValid; }
+};
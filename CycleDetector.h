@@ -0,0 +1,71 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+//Finds loops whose iterations bring the simulation back to a state it was already in
+//States are taken at a loop's back edge without that loop's own counter, so a repeated state
+//means every remaining iteration replays the same period and whole periods can be skipped
+class CycleDetector {
+private:
+	struct Entry {
+		std::vector<int32_t> state;
+		int32_t counter;			 //Iterations the loop had left
+		std::size_t nSteps, nCounted; //Moves played & moves counted so far
+		uint64_t nInstructions;		 //Instructions executed so far
+	};
+
+	std::unordered_map<uint64_t, Entry> entries;
+	std::size_t maxEntries;
+
+	static uint64_t Hash(const std::vector<int32_t>& state) {
+		uint64_t hash = 0xCBF29CE484222325ull;
+		for (int32_t value : state) {
+			hash = (hash ^ (uint32_t)value) * 0x100000001B3ull;
+		}
+		return hash;
+	}
+public:
+	struct Skip {
+		int32_t period, nPeriods;				//Iterations per period & whole periods to skip
+		std::size_t nPeriodSteps, nPeriodCounted; //Moves played & counted per period
+		uint64_t nPeriodInstructions;			//Instructions executed per period
+	};
+
+	CycleDetector() {
+		maxEntries = 1 << 16;
+	}
+
+	//Records the state at a loop's back edge, returns true with the periods to skip when the state was seen before
+	bool Check(const std::vector<int32_t>& state, int32_t counter, std::size_t nSteps, std::size_t nCounted, uint64_t nInstructions, Skip& skip) {
+		uint64_t hash = Hash(state);
+
+		auto it = entries.find(hash);
+		if (it != entries.end() && it->second.counter > counter && it->second.state == state) {
+			Entry& entry = it->second;
+
+			skip.period = entry.counter - counter;
+			skip.nPeriods = (counter - 1) / skip.period; //At least one iteration is left to play normally
+			skip.nPeriodSteps = nSteps - entry.nSteps;
+			skip.nPeriodCounted = nCounted - entry.nCounted;
+			skip.nPeriodInstructions = nInstructions - entry.nInstructions;
+
+			entry.counter = counter - skip.period * skip.nPeriods;
+			entry.nSteps = nSteps + skip.nPeriodSteps * skip.nPeriods;
+			entry.nCounted = nCounted + skip.nPeriodCounted * skip.nPeriods;
+			entry.nInstructions = nInstructions + skip.nPeriodInstructions * skip.nPeriods;
+
+			return skip.nPeriods > 0;
+		}
+
+		if (entries.size() >= maxEntries) entries.clear();
+		entries[hash] = { state, counter, nSteps, nCounted, nInstructions };
+
+		return false;
+	}
+
+	void Clear() {
+		entries.clear();
+	}
+};
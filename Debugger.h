@@ -0,0 +1,82 @@
+#pragma once
+#include "Simulation.h"
+
+//Single steps a run in a World forwards and backwards
+//Every interval moves the run state goes into a ring buffer of snapshots, a step back restores the nearest snapshot
+//at or before the move before the current one and plays forward from it, so it never replays more than interval moves
+//Stepping back stops at the oldest snapshot still in the buffer
+class Debugger {
+private:
+	std::vector<RunState> snapshots;
+	std::vector<std::size_t> snapshotMoves; //Moves played when each snapshot was taken
+	std::size_t first, count;				//Oldest snapshot & number of snapshots in the ring
+	std::size_t interval;
+	std::size_t nMoves; //Moves played since the run started
+	bool isActive;		//false -> the run was not started here or was skipped ahead without it
+
+	void TakeSnapshot(const World& world) {
+		std::size_t slot = (first + count) % snapshots.size();
+		if (count == snapshots.size()) first = (first + 1) % snapshots.size();
+		else count++;
+
+		world.GetRunState(snapshots[slot]);
+		snapshotMoves[slot] = nMoves;
+	}
+
+	inline std::size_t GetSlot(std::size_t i) const { return (first + i) % snapshots.size(); }
+public:
+	Debugger(std::size_t interval = 64, std::size_t capacity = 256)
+		: snapshots(capacity), snapshotMoves(capacity), interval(interval) {
+		first = count = 0;
+		nMoves = 0;
+		isActive = false;
+	}
+
+	//Call right after the world starts a run
+	void Start(const World& world) {
+		first = count = 0;
+		nMoves = 0;
+		isActive = true;
+		TakeSnapshot(world);
+	}
+
+	//The run moves on without the debugger (such as skipping to its end), stepping back is no longer possible
+	void Stop() { isActive = false; }
+
+	//World::Step that also keeps the snapshots
+	Yield Step(World& world, uint32_t instructionBudget) {
+		Yield yield = world.Step(instructionBudget);
+		if (yield != Yield::Move || !isActive) return yield;
+
+		nMoves++;
+		bool isSnapshotDue = nMoves % interval == 0 && snapshotMoves[GetSlot(count - 1)] < nMoves;
+		if (isSnapshotDue) TakeSnapshot(world);
+
+		return yield;
+	}
+
+	//Takes the run back by one move, returns false when it is at its start or older than the oldest snapshot
+	bool StepBack(World& world) {
+		if (!isActive || nMoves == 0) return false;
+
+		const std::size_t target = nMoves - 1;
+
+		std::size_t i = count;
+		while (i > 0 && snapshotMoves[GetSlot(i - 1)] > target) i--;
+		if (i == 0) return false;
+
+		const std::size_t slot = GetSlot(i - 1);
+		world.SetRunState(snapshots[slot]);
+		nMoves = snapshotMoves[slot];
+
+		while (nMoves < target && world.GetIsRun()) {
+			if (Step(world, UINT32_MAX) == Yield::Done) break;
+		}
+
+		return true;
+	}
+
+	inline bool GetIsActive() const { return isActive; }
+	inline std::size_t GetMoveCount() const { return nMoves; }
+	inline bool GetIsStepBackPossible() const { return isActive && count > 0 && nMoves > 0 && snapshotMoves[first] < nMoves; }
+};
@@ -9,136 +9,10 @@
 #include <sstream>
 #include <fstream>
 #include <list>
+#include <string_view>
+#include "Level.h"
 
-struct Tile {
-	int x, y;
-	char tileCharacter;
-
-	Tile(int x, int y, char c) 
-		: x(x), y(y), tileCharacter(c) {}
-};
-
-class Level {
-private:
-	std::vector<std::string> levelVector;
-	uint32_t width, height;
-public:
-	Level() {
-		width = height = 0;
-	}
-
-	Level(const std::vector<std::string>& level, uint32_t w, uint32_t h)
-		: levelVector(level), width(w), height(h) {}
-
-	void SetSize(uint32_t w, uint32_t h) {
-		width = w;
-		height = h;
-	}
-
-	void InitializeLevelString() {
-		for (int i = 0; i < (int)height; i++) {
-			std::string line;
-			for (int j = 0; j < (int)width; j++) {
-				line.push_back('.');
-			}
-			levelVector.push_back(line);
-		}
-	}
-
-	void ClearLevel() {
-		levelVector.clear();
-	}
-
-	void SetCharacter(uint32_t x, uint32_t y, char c) {
-		if (x < 0 || y < 0 || x > (width - 1) || y > (height - 1)) return;
-		levelVector[y][x] = c;
-	}
-
-	inline char GetCharacter(uint32_t x, uint32_t y) const {
-		if (x < 0 || y < 0 || x > (width - 1) || y > (height - 1)) return '\0';
-		return levelVector[y][x];
-	}
-
-	void InitializeLevelString(uint32_t w, uint32_t h) {
-
-		width = w;
-		height = h;
-
-		for (int i = 0; i < (int)h; i++) {
-			std::string line;
-			for (int j = 0; j < (int)w; j++) {
-				line.push_back('.');
-			}
-			levelVector.push_back(line);
-		}
-	}
-
-	static Level LoadLevel(const std::string& filepath) {
-		std::ifstream reader(filepath);
-		
-		Level level;
-
-		if (reader.is_open()) {
-
-			while (!reader.eof()) {
-				std::string line;
-				reader >> line;
-				level.levelVector.push_back(line);
-			}
-
-			reader.close();
-		}
-
-		level.width = level.levelVector[0].size();
-		level.height = level.levelVector.size();
-
-		return level;
-	}
-	
-	void SetLevel(const std::vector<std::string>& level) {
-		levelVector = level;
-		width = level[0].size();
-		height = level.size();
-	}
-
-	void SaveLevel(const std::string& filename) {
-		std::ofstream writer("files/levels/" + filename);
-
-		if (writer.is_open()) {
-			for (uint32_t i = 0; i < height; i++) {
-				writer << levelVector[i] << "\n";
-			}
-			writer.close();
-		}
-	}
-
-	static Level LoadLevel(const std::list<Tile>& positions, uint32_t levelWidth, uint32_t levelHeight) {
-		Level level;
-		level.SetSize(levelWidth, levelHeight);
-		level.InitializeLevelString();
-
-		for (auto& pos : positions) {
-			if (pos.x < 0 || pos.x > (int)(levelWidth - 1) || pos.y < 0 || pos.y > (int)(levelHeight - 1)) continue;
-			level.levelVector[pos.y][pos.x] = pos.tileCharacter;
-		}
-
-		return level;
-	}
-
-	void PrintLevel() {
-		system("cls");
-		for (std::size_t i = 0; i < height; i++) {
-			std::cout << levelVector[i] << std::endl;
-		}
-	}
-
-	inline uint32_t GetWidth() const { return width; }
-	inline uint32_t GetHeight() const { return height; }
-
-	std::vector<std::string> GetLevel() const { return levelVector; }
-};
-
-void DrawLine(sf::RenderWindow& window, float x1, float y1, float x2, float y2, sf::Color color = sf::Color::White) {
+void DrawLine(sf::RenderTarget& window, float x1, float y1, float x2, float y2, sf::Color color = sf::Color::White) {
 	sf::VertexArray line(sf::LineStrip, 2);
 
 	line[0].position = { x1, y1 };
@@ -200,22 +74,71 @@ void DrawEllipse(sf::RenderWindow& window, const sf::Vector2f& origin, float wid
 	}
 }
 
-void RenderText(sf::RenderWindow& window, const sf::Font& font, float x, float y, const std::string& str, sf::Color color = sf::Color::White, uint32_t characterSize = 32) {
-	sf::Text text(str, font, characterSize);
-	text.setPosition({ x, y });
-	text.setFillColor(color);
+//Text of one widget kept from frame to frame by the widget that draws it
+//It is only laid out again when its string changes, a new font, size or position is a cheap update
+class CachedText {
+private:
+	sf::Text text;
+	std::string string; //Last string laid out
+	std::string label;	//Label & value of a text drawn with a value
+	int64_t value;
+	bool isValue;
+public:
+	CachedText() {
+		value = 0;
+		isValue = false;
+	}
+
+	void Set(const sf::Font& font, float x, float y, sf::Color color, uint32_t characterSize) {
+		text.setFont(font);
+		text.setCharacterSize(characterSize);
+		text.setPosition({ x, y });
+		text.setFillColor(color);
+	}
+
+	void SetString(std::string_view str) {
+		isValue = false;
+		if (string == str) return;
+
+		string = str;
+		text.setString(string);
+	}
+
+	//Formats the text only when the label or the value changed
+	void SetValue(std::string_view str, int64_t newValue) {
+		if (isValue && value == newValue && label == str) return;
 
-	window.draw(text);
+		std::string formatted(str);
+		formatted += ' ';
+		formatted += std::to_string(newValue);
+		SetString(formatted);
+
+		label = str;
+		value = newValue;
+		isValue = true;
+	}
+
+	inline const sf::Text& GetText() const { return text; }
+};
+
+//Rasterizes the printable ASCII glyphs of a font at each size ahead of time, so the first frame that draws
+//text at one of them does not stall on the font's texture
+void PrewarmGlyphs(const sf::Font& font, const std::vector<uint32_t>& characterSizes) {
+	for (uint32_t characterSize : characterSizes) {
+		for (sf::Uint32 c = 32; c < 127; c++) font.getGlyph(c, characterSize, false);
+	}
 }
 
-void DrawTextWithValue(sf::RenderWindow& window, const sf::Font& font, float x, float y, const std::string& str, float value, sf::Color color = sf::Color::White, uint32_t characterSize = 32) {
-	sf::Text text(str, font, characterSize);
-	text.setPosition({ x, y });
-	text.setFillColor(color);
+void RenderText(CachedText& cache, sf::RenderTarget& window, const sf::Font& font, float x, float y, std::string_view str, sf::Color color = sf::Color::White, uint32_t characterSize = 32) {
+	cache.Set(font, x, y, color, characterSize);
+	cache.SetString(str);
 
-	std::stringstream ss;
-	ss << str << " " << value;
-	text.setString(ss.str());
+	window.draw(cache.GetText());
+}
+
+void DrawTextWithValue(CachedText& cache, sf::RenderTarget& window, const sf::Font& font, float x, float y, std::string_view str, int64_t value, sf::Color color = sf::Color::White, uint32_t characterSize = 32) {
+	cache.Set(font, x, y, color, characterSize);
+	cache.SetValue(str, value);
 
-	window.draw(text);
-}
\ No newline at end of file
+	window.draw(cache.GetText());
+}
@@ -7,7 +7,7 @@
 #include <SFML/Window/Event.hpp>
 #include <SFML/Graphics/Text.hpp>
 #include <sstream>
-#include <Windows.h>
+#include <algorithm>
 using namespace sf;
 
 class Slider {
@@ -24,9 +24,11 @@ public:
 		sliderBar.setFillColor(sliderBarColor);
 
 		circle.setRadius(radius);
-		circle.setOrigin({ radius / 2.0f, radius / 2.0f });
+		circle.setOrigin({ radius, radius });
 		circle.setFillColor(circleColor);
-		circle.setPosition(pos);
+		circle.setPosition({ pos.x, pos.y + sliderBarSize.y / 2.0f });
+
+		value = 0;
 	}
 
 	void Initialize(const Vector2f& pos, const Vector2f& sliderBarSize, const float radius, const Color& sliderBarColor, const Color& circleColor) {
@@ -35,9 +37,11 @@ public:
 		sliderBar.setFillColor(sliderBarColor);
 
 		circle.setRadius(radius);
-		circle.setOrigin({ radius / 2.0f, radius / 2.0f });
+		circle.setOrigin({ radius, radius });
 		circle.setFillColor(circleColor);
-		circle.setPosition(pos);
+		circle.setPosition({ pos.x, pos.y + sliderBarSize.y / 2.0f });
+
+		value = 0;
 	}
 
 	void SetTexture(Texture& texture) {
@@ -50,6 +54,13 @@ public:
 	}
 
 	inline int GetValue() const { return value; }
+	inline int GetLength() const { return (int)sliderBar.getSize().x; }
+
+	//Moves the knob to a value between 0 and the bar's length
+	void SetValue(int newValue) {
+		value = std::min(std::max(newValue, 0), GetLength());
+		circle.setPosition({ sliderBar.getPosition().x + (float)value, circle.getPosition().y });
+	}
 
 	void Logic(Vector2f mousePos) {
 		float sliderLeft = sliderBar.getPosition().x;
@@ -0,0 +1,489 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <charconv>
+#include <climits>
+#include <cassert>
+#include <cctype>
+#include <cstdint>
+
+enum class Keyword : uint8_t {
+	None = 0,
+	Move, Turn, Repeat, Loop, End, CloseLoop, If, Else, EndIf, CloseIf,
+	Fd, Bk, Rt, Right, Lt, Left, Empty
+};
+
+struct Token {
+	std::string_view text;
+	Keyword keyword;
+};
+
+const std::size_t maxTokens = 4; //Console commands are at most 3 words, further words are dropped
+
+inline Keyword ToKeyword(std::string_view word) {
+	static const std::pair<std::string_view, Keyword> keywords[] = {
+		{ "move", Keyword::Move }, { "turn", Keyword::Turn }, { "repeat", Keyword::Repeat }, { "loop", Keyword::Loop },
+		{ "end", Keyword::End }, { "closeloop", Keyword::CloseLoop }, { "if", Keyword::If }, { "else", Keyword::Else },
+		{ "endif", Keyword::EndIf }, { "closeif", Keyword::CloseIf }, { "fd", Keyword::Fd }, { "bk", Keyword::Bk },
+		{ "rt", Keyword::Rt }, { "right", Keyword::Right }, { "lt", Keyword::Lt }, { "left", Keyword::Left },
+		{ "empty", Keyword::Empty }
+	};
+
+	for (const auto& [name, keyword] : keywords) {
+		if (name == word) return keyword;
+	}
+
+	return Keyword::None;
+}
+
+//Splits a line on whitespace into caller storage without allocating, returns the number of tokens
+//Everything from a word starting with // is a comment
+inline std::size_t Tokenize(std::string_view line, Token (&tokens)[maxTokens]) {
+	std::size_t nTokens = 0, i = 0;
+
+	while (nTokens < maxTokens) {
+		while (i < line.size() && std::isspace((unsigned char)line[i])) i++;
+		if (i == line.size()) break;
+		if (line.compare(i, 2, "//") == 0) break;
+
+		std::size_t start = i;
+		while (i < line.size() && !std::isspace((unsigned char)line[i])) i++;
+
+		tokens[nTokens].text = line.substr(start, i - start);
+		tokens[nTokens].keyword = ToKeyword(tokens[nTokens].text);
+		nTokens++;
+	}
+
+	return nTokens;
+}
+
+//Grid offsets of the four facings (0 -> Right, 1 -> Down, 2 -> Left, 3 -> Up)
+const int directionX[4] = { 1, 0, -1, 0 };
+const int directionY[4] = { 0, 1, 0, -1 };
+
+enum class Condition : uint8_t {
+	FdEmpty = 0,
+	Always = 1
+};
+
+//Statement of a console program, repeat and if statements own their nested blocks
+struct Statement {
+	enum class Type : uint8_t {
+		Move = 0,	//arg -> direction relative to facing (0 -> fd, 2 -> bk)
+		Turn = 1,	//arg -> quarter turns clockwise
+		Repeat = 2,	//arg -> loop count
+		If = 3		//arg -> Condition
+	} type;
+
+	int arg;
+	int line, elseLine, endLine; //Console lines of the statement, its else and its closing keyword (-1 if absent)
+	std::vector<Statement> body, elseBody;
+
+	Statement(Type type, int arg, int line)
+		: type(type), arg(arg), line(line), elseLine(-1), endLine(-1) {}
+};
+
+typedef std::vector<Statement> Block;
+
+//Recursive-descent parser building the block tree of a console program in one pass over its lines
+class Parser {
+private:
+	enum class Context : uint8_t { Top, Loop, Then, Else };
+	enum class Terminator : uint8_t { None, End, Else, EndIf };
+
+	const std::vector<std::string>& strings;
+	int line;
+	Terminator terminator; //Closing keyword that ended the last block
+
+	Parser(const std::vector<std::string>& strings)
+		: strings(strings), line(0), terminator(Terminator::None) {}
+
+	static int ParseCount(std::string_view str) {
+		int n = 0;
+		auto [end, error] = std::from_chars(str.data(), str.data() + str.size(), n);
+		if (error == std::errc::result_out_of_range) return str[0] == '-' ? 0 : INT_MAX;
+
+		return n < 0 ? 0 : n;
+	}
+
+	//Parses statements until a closing keyword of an enclosing block, which is left unconsumed
+	Block ParseBlock(Context context, int loopDepth) {
+		Block block;
+
+		for (; line < (int)strings.size(); line++) {
+			Token text[maxTokens];
+			std::size_t nTokens = Tokenize(strings[line], text);
+			if (nTokens == 0) continue;
+
+			Keyword argument = nTokens >= 2 ? text[1].keyword : Keyword::None;
+
+			switch (text[0].keyword) {
+			//Closing keywords without a matching block are ignored
+			case Keyword::End:
+			case Keyword::CloseLoop:
+				if (loopDepth == 0) continue;
+				terminator = Terminator::End;
+				return block;
+			case Keyword::Else:
+				if (context != Context::Then) continue;
+				terminator = Terminator::Else;
+				return block;
+			case Keyword::EndIf:
+			case Keyword::CloseIf:
+				if (context != Context::Then && context != Context::Else) continue;
+				terminator = Terminator::EndIf;
+				return block;
+			case Keyword::Move:
+				if (argument == Keyword::Fd) block.emplace_back(Statement::Type::Move, 0, line);
+				else if (argument == Keyword::Bk) block.emplace_back(Statement::Type::Move, 2, line);
+				break;
+			case Keyword::Turn:
+				if (argument == Keyword::Rt || argument == Keyword::Right) block.emplace_back(Statement::Type::Turn, 1, line);
+				else if (argument == Keyword::Lt || argument == Keyword::Left) block.emplace_back(Statement::Type::Turn, 3, line);
+				break;
+			case Keyword::Repeat:
+			case Keyword::Loop: {
+				if (nTokens < 2) continue;
+
+				Statement statement(Statement::Type::Repeat, ParseCount(text[1].text), line++);
+				statement.body = ParseBlock(Context::Loop, loopDepth + 1);
+				if (terminator == Terminator::End) statement.endLine = line;
+
+				block.push_back(std::move(statement));
+
+				//Unterminated loops end with the program
+				if (terminator == Terminator::None) return block;
+				break;
+			}
+			case Keyword::If: {
+				bool isFdEmpty = nTokens >= 3 && argument == Keyword::Fd && text[2].keyword == Keyword::Empty;
+
+				Statement statement(Statement::Type::If, (int)(isFdEmpty ? Condition::FdEmpty : Condition::Always), line++);
+				statement.body = ParseBlock(Context::Then, loopDepth);
+				if (terminator == Terminator::Else) {
+					statement.elseLine = line++;
+					statement.elseBody = ParseBlock(Context::Else, loopDepth);
+				}
+				if (terminator == Terminator::EndIf) statement.endLine = line;
+
+				block.push_back(std::move(statement));
+
+				//Ifs left open are closed by the enclosing loop's end or by the end of the program
+				if (terminator == Terminator::End || terminator == Terminator::None) return block;
+				break;
+			}
+			//Arguments & unknown words do not start a statement
+			default:
+				break;
+			}
+		}
+
+		terminator = Terminator::None;
+		return block;
+	}
+public:
+	static Block Parse(const std::vector<std::string>& strings) {
+		Parser parser(strings);
+		return parser.ParseBlock(Context::Top, 0);
+	}
+};
+
+enum class OpCode : uint8_t {
+	Move = 0,		//arg -> direction relative to facing (0 -> fd, 2 -> bk)
+	Turn = 1,		//arg -> quarter turns clockwise
+	Repeat = 2,		//operand -> loop count, jump -> instruction after the matching EndRepeat
+	EndRepeat = 3,	//jump -> first instruction of the loop body
+	If = 4,			//arg -> Condition, jump -> else branch (or instruction after endif)
+	Jump = 5		//jump -> instruction after endif
+};
+
+struct Instruction {
+	OpCode op;
+	int8_t arg;
+	int32_t operand;
+	int32_t jump;
+
+	Instruction(OpCode op, int arg = 0, int operand = 0)
+		: op(op), arg((int8_t)arg), operand(operand), jump(0) {}
+
+	inline bool HasJump() const { return op != OpCode::Move && op != OpCode::Turn; }
+};
+
+//Block tree compiled once into a flat instruction stream with resolved jump targets
+class Program {
+private:
+	std::vector<Instruction> instructions;
+
+	int32_t Emit(OpCode op, int arg = 0, int operand = 0) {
+		instructions.emplace_back(op, arg, operand);
+		return (int32_t)instructions.size() - 1;
+	}
+
+	void Generate(const Block& block) {
+		for (const auto& statement : block) {
+			switch (statement.type) {
+			case Statement::Type::Move:
+				Emit(OpCode::Move, statement.arg);
+				break;
+			case Statement::Type::Turn:
+				Emit(OpCode::Turn, statement.arg);
+				break;
+			case Statement::Type::Repeat: {
+				int32_t start = Emit(OpCode::Repeat, 0, statement.arg);
+				Generate(statement.body);
+				instructions[Emit(OpCode::EndRepeat)].jump = start + 1;
+				instructions[start].jump = (int32_t)instructions.size();
+				break;
+			}
+			case Statement::Type::If: {
+				int32_t start = Emit(OpCode::If, statement.arg);
+				Generate(statement.body);
+
+				if (statement.elseBody.size() > 0) {
+					int32_t jump = Emit(OpCode::Jump);
+					instructions[start].jump = (int32_t)instructions.size();
+					Generate(statement.elseBody);
+					instructions[jump].jump = (int32_t)instructions.size();
+				}
+				else {
+					instructions[start].jump = (int32_t)instructions.size();
+				}
+				break;
+			}
+			}
+		}
+	}
+
+	//Peephole passes: merges adjacent turns, drops full rotations and collapses trivial loops
+	void Optimize() {
+		bool isChanged = true;
+
+		while (isChanged) {
+			const int32_t n = (int32_t)instructions.size();
+
+			std::vector<bool> isTarget(n + 1, false);
+			for (const auto& instruction : instructions) {
+				if (instruction.HasJump()) isTarget[instruction.jump] = true;
+			}
+
+			std::vector<Instruction> optimized;
+			std::vector<int32_t> newIndex(n + 1);
+			bool isBarrier = false; //A jump lands on the next instruction kept, so no turn may merge into the one before it
+
+			for (int32_t i = 0; i < n; i++) {
+				newIndex[i] = (int32_t)optimized.size();
+				if (isTarget[i]) isBarrier = true;
+				const Instruction& instruction = instructions[i];
+
+				switch (instruction.op) {
+				case OpCode::Repeat:
+					//Loops that never run or have an empty body
+					if (instruction.operand == 0 || instructions[i + 1].op == OpCode::EndRepeat) {
+						for (int32_t j = i + 1; j < instruction.jump; j++) newIndex[j] = newIndex[i];
+						i = instruction.jump - 1;
+						continue;
+					}
+
+					//Loops of a single turn become one turn
+					if (instructions[i + 1].op == OpCode::Turn && instructions[i + 2].op == OpCode::EndRepeat) {
+						newIndex[i + 1] = newIndex[i + 2] = newIndex[i];
+						optimized.emplace_back(OpCode::Turn, (int)(((int64_t)instructions[i + 1].arg * instruction.operand) % 4));
+						isBarrier = false;
+						i += 2;
+						continue;
+					}
+					break;
+				case OpCode::If:
+					//Unknown conditions always take the first branch
+					if ((Condition)instruction.arg == Condition::Always) continue;
+					break;
+				case OpCode::Turn:
+					if (instruction.arg % 4 == 0) continue;
+
+					if (!isBarrier && optimized.size() > 0 && optimized.back().op == OpCode::Turn) {
+						optimized.back().arg = (int8_t)((optimized.back().arg + instruction.arg) % 4);
+						if (optimized.back().arg == 0) {
+							//Jumps to the dropped turn now land on whatever follows it
+							optimized.pop_back();
+							isBarrier = true;
+						}
+						continue;
+					}
+					break;
+				default:
+					break;
+				}
+
+				optimized.push_back(instruction);
+				isBarrier = false;
+			}
+
+			newIndex[n] = (int32_t)optimized.size();
+			for (auto& instruction : optimized) {
+				if (instruction.HasJump()) instruction.jump = newIndex[instruction.jump];
+			}
+
+			isChanged = optimized.size() != instructions.size();
+			instructions = std::move(optimized);
+		}
+	}
+public:
+	Program() {}
+
+	static Program Compile(const Block& block) {
+		Program program;
+		program.Generate(block);
+		program.Optimize();
+
+		return program;
+	}
+
+	static Program Compile(const std::vector<std::string>& strings) {
+		return Compile(Parser::Parse(strings));
+	}
+
+	inline std::size_t GetSize() const { return instructions.size(); }
+	inline const Instruction& operator[](std::size_t i) const { return instructions[i]; }
+	inline const std::vector<Instruction>& GetInstructions() const { return instructions; }
+};
+
+enum class Yield : uint8_t {
+	Move = 0,		//moveDirection holds the next move
+	Pending = 1,	//Instruction budget ran out before the next move, call again to resume
+	Done = 2,		//Program finished or was aborted at the instruction limit
+	Loop = 3		//A loop is about to run its body again (only when breaking on loops)
+};
+
+//Resumable executor of a Program that yields one move at a time, memory is bounded by the loop nesting depth
+class Interpreter {
+private:
+	std::shared_ptr<const Program> program;
+	std::vector<int32_t> loopCounters; //Remaining iterations of the open loops, innermost last
+	int32_t pc;
+	int direction;
+
+	uint64_t nInstructions, instructionLimit; //Instructions executed since Load & hard cap before aborting
+	bool isAborted, isLoopBreak;
+public:
+	//Where a run of the loaded program is, enough to resume it from there
+	struct State {
+		std::vector<int32_t> loopCounters;
+		int32_t pc;
+		int direction;
+		uint64_t nInstructions;
+		bool isAborted;
+	};
+
+	Interpreter() {
+		program = std::make_shared<const Program>();
+		pc = 0;
+		direction = 0;
+		nInstructions = 0;
+		instructionLimit = 100000000;
+		isAborted = false;
+		isLoopBreak = false;
+	}
+
+	void SetInstructionLimit(uint64_t limit) { instructionLimit = limit; }
+	void SetIsLoopBreak(bool state) { isLoopBreak = state; }
+
+	//Drops iterations of the innermost loop, which must keep at least one, counting the instructions they would have run
+	void SkipIterations(int32_t n, uint64_t nSkippedInstructions) {
+		loopCounters.back() -= n;
+		nInstructions += nSkippedInstructions;
+	}
+
+	void Load(std::shared_ptr<const Program> newProgram, int startDirection) {
+		program = std::move(newProgram);
+		loopCounters.clear();
+		pc = 0;
+		direction = startDirection;
+		nInstructions = 0;
+		isAborted = false;
+	}
+
+	void GetState(State& state) const {
+		state.loopCounters = loopCounters;
+		state.pc = pc;
+		state.direction = direction;
+		state.nInstructions = nInstructions;
+		state.isAborted = isAborted;
+	}
+
+	//Resumes the loaded program from a state taken while it ran
+	void SetState(const State& state) {
+		loopCounters = state.loopCounters;
+		pc = state.pc;
+		direction = state.direction;
+		nInstructions = state.nInstructions;
+		isAborted = state.isAborted;
+	}
+
+	void Stop() {
+		pc = (int32_t)program->GetSize();
+		loopCounters.clear();
+	}
+
+	//Runs up to the next move executing at most budget instructions, isFdEmpty(direction) answers the if conditions
+	template<typename Sense>
+	Yield Next(int& moveDirection, Sense isFdEmpty, uint32_t budget = UINT32_MAX) {
+		const Program& code = *program;
+
+		while (pc < (int32_t)code.GetSize()) {
+			if (budget-- == 0) return Yield::Pending;
+
+			if (nInstructions++ >= instructionLimit) {
+				Stop();
+				isAborted = true;
+				return Yield::Done;
+			}
+
+			const Instruction& instruction = code[pc++];
+
+			switch (instruction.op) {
+			case OpCode::Move:
+				moveDirection = (direction + instruction.arg) % 4;
+				return Yield::Move;
+			case OpCode::Turn:
+				direction = (direction + instruction.arg) % 4;
+				break;
+			case OpCode::Repeat:
+				if (instruction.operand > 0) loopCounters.push_back(instruction.operand);
+				else pc = instruction.jump;
+				break;
+			case OpCode::EndRepeat:
+				//A compiled program never ends a loop it did not open
+				assert(!loopCounters.empty());
+				if (loopCounters.empty()) break;
+
+				if (--loopCounters.back() > 0) {
+					pc = instruction.jump;
+					if (isLoopBreak) return Yield::Loop;
+				}
+				else {
+					loopCounters.pop_back();
+				}
+				break;
+			case OpCode::If:
+				if (!isFdEmpty(direction)) pc = instruction.jump;
+				break;
+			case OpCode::Jump:
+				pc = instruction.jump;
+				break;
+			}
+		}
+
+		return Yield::Done;
+	}
+
+	inline bool IsFinished() const { return pc >= (int32_t)program->GetSize(); }
+	inline bool IsAborted() const { return isAborted; }
+	inline uint64_t GetInstructionCount() const { return nInstructions; }
+	inline uint64_t GetInstructionLimit() const { return instructionLimit; }
+	inline int32_t GetPc() const { return pc; }
+	inline const std::vector<int32_t>& GetLoopCounters() const { return loopCounters; }
+	inline int GetDirection() const { return direction; }
+};
@@ -0,0 +1,158 @@
+#pragma once
+#include "ChunkedGrid.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <list>
+#include <fstream>
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+
+struct Tile {
+	int x, y;
+	char tileCharacter;
+
+	Tile(int x, int y, char c) 
+		: x(x), y(y), tileCharacter(c) {}
+};
+
+//Grid of characters kept in chunks, the level's most common character is the background no chunk is allocated for
+//so a large level costs memory for its painted cells only
+class Level {
+private:
+	ChunkedGrid<char> cells;
+	uint32_t width, height;
+
+	//Most common character of the rows, short rows counting their padding
+	static char GetBackground(const std::vector<std::string>& level, uint32_t w, uint32_t h) {
+		std::vector<std::size_t> counts(256, 0);
+		for (uint32_t i = 0; i < h; i++) {
+			const std::string* row = i < level.size() ? &level[i] : nullptr;
+			for (uint32_t j = 0; j < w; j++) {
+				counts[(uint8_t)(row && j < row->size() ? (*row)[j] : '\0')]++;
+			}
+		}
+		return (char)(std::max_element(counts.begin(), counts.end()) - counts.begin());
+	}
+
+	void SetRows(const std::vector<std::string>& level) {
+		cells.Reset(width, height, GetBackground(level, width, height));
+		for (uint32_t i = 0; i < height; i++) {
+			for (uint32_t j = 0; j < width; j++) {
+				cells.Set(j, i, i < level.size() && j < level[i].size() ? level[i][j] : '\0');
+			}
+		}
+	}
+public:
+	Level() {
+		width = height = 0;
+	}
+
+	Level(const std::vector<std::string>& level, uint32_t w, uint32_t h)
+		: width(w), height(h) {
+		SetRows(level);
+	}
+
+	void SetSize(uint32_t w, uint32_t h) {
+		width = w;
+		height = h;
+	}
+
+	void InitializeLevelString() {
+		cells.Reset(width, height, '.');
+	}
+
+	void ClearLevel() {
+		width = height = 0;
+		cells.Reset(0, 0, '\0');
+	}
+
+	void SetCharacter(uint32_t x, uint32_t y, char c) {
+		if (x >= width || y >= height) return;
+		cells.Set(x, y, c);
+	}
+
+	inline char GetCharacter(uint32_t x, uint32_t y) const {
+		if (x >= width || y >= height) return '\0';
+		return cells.Get(x, y);
+	}
+
+	void InitializeLevelString(uint32_t w, uint32_t h) {
+		width = w;
+		height = h;
+		InitializeLevelString();
+	}
+
+	static Level LoadLevel(const std::string& filepath) {
+		std::ifstream reader(filepath);
+		
+		std::vector<std::string> lines;
+
+		if (reader.is_open()) {
+
+			while (!reader.eof()) {
+				std::string line;
+				reader >> line;
+				lines.push_back(line);
+			}
+
+			reader.close();
+		}
+
+		Level level;
+		level.SetLevel(lines);
+		return level;
+	}
+	
+	//Rows as text, the first row sets the width and shorter rows are padded with '\0'
+	void SetLevel(const std::vector<std::string>& level) {
+		width = level.empty() ? 0 : (uint32_t)level[0].size();
+		height = (uint32_t)level.size();
+		SetRows(level);
+	}
+
+	void SaveLevel(const std::string& filename) {
+		std::ofstream writer("files/levels/" + filename);
+
+		if (writer.is_open()) {
+			for (uint32_t i = 0; i < height; i++) {
+				writer << GetRow(i) << "\n";
+			}
+			writer.close();
+		}
+	}
+
+	static Level LoadLevel(const std::list<Tile>& positions, uint32_t levelWidth, uint32_t levelHeight) {
+		Level level;
+		level.SetSize(levelWidth, levelHeight);
+		level.InitializeLevelString();
+
+		for (auto& pos : positions) {
+			if (pos.x < 0 || pos.x > (int)(levelWidth - 1) || pos.y < 0 || pos.y > (int)(levelHeight - 1)) continue;
+			level.SetCharacter(pos.x, pos.y, pos.tileCharacter);
+		}
+
+		return level;
+	}
+
+	void PrintLevel() {
+		system("cls");
+		for (uint32_t i = 0; i < height; i++) {
+			std::cout << GetRow(i) << std::endl;
+		}
+	}
+
+	inline uint32_t GetWidth() const { return width; }
+	inline uint32_t GetHeight() const { return height; }
+
+	inline const ChunkedGrid<char>& GetCells() const { return cells; }
+
+	std::string GetRow(uint32_t y) const {
+		std::string row(width, '\0');
+		for (uint32_t j = 0; j < width; j++) row[j] = cells.Get(j, y);
+		return row;
+	}
+};
+
+typedef Level ItemMap;
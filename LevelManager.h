@@ -0,0 +1,130 @@
+#pragma once
+#include "Level.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+//Campaign levels listed in files/levels/LevelStrings.txt & the opponent patrols of files/opponentPos.txt
+class LevelManager {
+private:
+
+	struct LevelData {
+		std::string level, itemMap;
+
+		LevelData(const std::string& levelStr, const std::string& itemMapStr)
+			: level(levelStr), itemMap(itemMapStr) {}
+	};
+
+	std::vector<LevelData> strings;
+	std::vector<std::string> opponentPaths; //Patrol of the n-th level with an opponent
+	std::vector<int> opponentPathIndices;   //Patrol used by each level
+	std::string folder, extension;
+
+	int index;
+
+	Level level;
+	ItemMap itemMap;
+	bool isWinTileActive;
+
+	void LoadLevel(std::string fileExtension = ".lvl") {
+		level = Level::LoadLevel(folder + strings[index].level + fileExtension);
+		itemMap = Level::LoadLevel(folder + strings[index].itemMap + fileExtension);
+	}
+public:
+	LevelManager() {
+		folder = "files/levels/";
+		extension = ".txt";
+		index = 0;
+
+		LoadLevelStrings("LevelStrings");
+	}
+
+	void LoadLevelStrings(const std::string& filename) {
+		std::ifstream reader(folder + filename + extension);
+
+		if (reader.is_open()) {
+
+			while (!reader.eof()) {
+				std::string levelName, itemMapName;
+				reader >> levelName >> itemMapName;
+				if (levelName.empty()) continue;
+				strings.emplace_back(levelName, itemMapName);
+			}
+
+			reader.close();
+		}
+
+		LoadOpponentPaths("files/opponentPos.txt");
+
+		if ((int)strings.size() > 0) {
+			LoadLevel();
+		}
+	}
+
+	//The game opens a new play session at these levels, after the menu & each scene
+	static constexpr int sessionStarts[] = { 0, 10, 19 };
+
+	//Opponent levels take the patrols of the file in order, counted again from the first at each session start
+	void LoadOpponentPaths(const std::string& filepath) {
+		std::ifstream reader(filepath);
+
+		if (reader.is_open()) {
+			std::string path;
+			while (reader >> path) {
+				opponentPaths.push_back(path);
+			}
+
+			reader.close();
+		}
+
+		int nOpponentLevels = 0;
+		for (const auto& data : strings) {
+			for (int start : sessionStarts) {
+				if ((int)opponentPathIndices.size() == start) {
+					nOpponentLevels = 0;
+				}
+			}
+			opponentPathIndices.push_back(nOpponentLevels);
+
+			std::ifstream itemMapReader(folder + data.itemMap + ".lvl");
+			std::string line;
+			while (std::getline(itemMapReader, line)) {
+				if (line.find('O') != std::string::npos) {
+					nOpponentLevels++;
+					break;
+				}
+			}
+		}
+	}
+
+	std::string GetOpponentPath() const {
+		int pathIndex = index < (int)opponentPathIndices.size() ? opponentPathIndices[index] : 0;
+		return pathIndex < (int)opponentPaths.size() ? opponentPaths[pathIndex] : "";
+	}
+
+	void LoadLevelFromFile(const std::string& filepath) {
+		level = Level::LoadLevel(filepath);
+	}
+
+	void LoadItemMap(const std::string& filepath) {
+		itemMap = ItemMap::LoadLevel(filepath);
+	}
+
+	Level& GetLevel() { return level; }
+	ItemMap& GetItemMap() {
+		return itemMap;
+	}
+	inline int GetIndex() const { return index; }
+	void SetIndex(int n) { 
+		index = n; 
+		LoadLevel();
+	}
+
+	inline int GetLevelCount() const { return (int)strings.size(); }
+
+	void ResetIndex() { index = 0; }
+	void LoadNextLevel() {
+		++index %= (int)strings.size();
+		LoadLevel();
+	}
+};
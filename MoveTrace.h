@@ -0,0 +1,140 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+//Packed record of the moves a run has played
+//Each move is one byte (bits 0-1 -> move direction, bits 2-3 -> facing, bit 4 -> counted by the move counter)
+//and repeated moves are run-length encoded into 4 bytes per run
+class MoveTrace {
+private:
+	static const uint32_t maxRunLength = (1u << 24) - 1;
+
+	std::vector<uint32_t> runs; //(length << 8) | move, a whole run fits one word so growing or skipping it is one add
+	std::size_t nMoves, nCounted;
+	bool isComplete; //Every move is stored, skipped periods that were not a single run only update the counts
+
+	static inline uint8_t GetRunMove(uint32_t run) { return (uint8_t)(run & 0xFF); }
+	static inline uint32_t GetRunLength(uint32_t run) { return run >> 8; }
+public:
+	MoveTrace() {
+		nMoves = 0;
+		nCounted = 0;
+		isComplete = true;
+	}
+
+	static inline uint8_t Pack(int moveDirection, int facing, bool isCounted) {
+		return (uint8_t)((moveDirection & 3) | (facing & 3) << 2 | (int)isCounted << 4);
+	}
+
+	static inline int GetMoveDirection(uint8_t move) { return move & 3; }
+	static inline int GetFacing(uint8_t move) { return (move >> 2) & 3; }
+	static inline bool GetIsCounted(uint8_t move) { return (move >> 4) & 1; }
+
+	void Push(uint8_t move) {
+		if (runs.size() > 0 && GetRunMove(runs.back()) == move && GetRunLength(runs.back()) < maxRunLength) {
+			runs.back() += 1u << 8;
+		}
+		else {
+			runs.push_back(1u << 8 | move);
+		}
+
+		nMoves++;
+		if (GetIsCounted(move)) nCounted++;
+	}
+
+	void Push(int moveDirection, int facing, bool isCounted) {
+		Push(Pack(moveDirection, facing, isCounted));
+	}
+
+	//Accounts for nPeriods repetitions of the last nPeriodMoves moves without playing them
+	void Skip(std::size_t nPeriodMoves, std::size_t nPeriodCounted, std::size_t nPeriods) {
+		if (nPeriodMoves == 0 || nPeriods == 0) return;
+
+		std::size_t nSkipped = nPeriodMoves * nPeriods;
+		nMoves += nSkipped;
+		nCounted += nPeriodCounted * nPeriods;
+
+		//The period is one repeated move only if the last run covers it
+		if (GetRunLength(runs.back()) < nPeriodMoves) {
+			isComplete = false;
+			return;
+		}
+
+		uint8_t move = Back();
+		while (nSkipped > 0) {
+			uint32_t room = maxRunLength - GetRunLength(runs.back());
+			if (room == 0) {
+				runs.push_back(move);
+				room = maxRunLength;
+			}
+
+			uint32_t n = (uint32_t)(nSkipped < room ? nSkipped : room);
+			runs.back() += n << 8;
+			nSkipped -= n;
+		}
+	}
+
+	//Drops the moves after the first n, nCounted of which are counted
+	//Moves no longer stored (after a reset or a skipped period) cannot be brought back, only the counts are
+	void Truncate(std::size_t n, std::size_t newNCounted) {
+		if (n > nMoves || !isComplete) {
+			isComplete = isComplete && n == nMoves;
+		}
+		else {
+			std::size_t nDropped = nMoves - n;
+			while (nDropped > 0) {
+				uint32_t length = GetRunLength(runs.back());
+				if (length > nDropped) {
+					runs.back() -= (uint32_t)nDropped << 8;
+					break;
+				}
+
+				runs.pop_back();
+				nDropped -= length;
+			}
+		}
+
+		nMoves = n;
+		nCounted = newNCounted;
+	}
+
+	void Clear() {
+		runs.clear();
+		nMoves = 0;
+		nCounted = 0;
+		isComplete = true;
+	}
+
+	//Iterates the moves one by one without expanding the runs
+	class Iterator {
+	private:
+		const uint32_t* run;
+		uint32_t offset;
+	public:
+		Iterator(const uint32_t* run, uint32_t offset)
+			: run(run), offset(offset) {}
+
+		inline uint8_t operator*() const { return GetRunMove(*run); }
+
+		Iterator& operator++() {
+			if (++offset >= GetRunLength(*run)) {
+				run++;
+				offset = 0;
+			}
+			return *this;
+		}
+
+		inline bool operator==(const Iterator& other) const { return run == other.run && offset == other.offset; }
+		inline bool operator!=(const Iterator& other) const { return !(*this == other); }
+	};
+
+	Iterator begin() const { return Iterator(runs.data(), 0); }
+	Iterator end() const { return Iterator(runs.data() + runs.size(), 0); }
+
+	inline bool IsEmpty() const { return nMoves == 0; }
+	inline uint8_t Back() const { return GetRunMove(runs.back()); }
+	inline std::size_t GetSize() const { return nMoves; }
+	inline std::size_t GetNCounted() const { return nCounted; }
+	inline std::size_t GetRunCount() const { return runs.size(); }
+};
@@ -0,0 +1,105 @@
+#pragma once
+#include "ChunkedGrid.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+//Which boxes, agents and toggle tiles sit on each cell of a level, kept up to date as they move
+//so the rules look a cell up instead of scanning every entity
+//Boxes may share a cell: those still on the board are chained in index order, the order the rules visit them in
+//Cells are kept in chunks, only those around entities are allocated
+class Occupancy {
+private:
+	struct Slot {
+		int32_t firstBox; //First box on the board in the cell, -1 -> none
+		int32_t tile;	  //Toggle tile in the cell, -1 -> none
+		uint16_t nBoxes;  //Boxes in the cell, on the board or not
+		uint16_t nAgents; //Players in the cell
+	};
+
+	int width, height;
+	ChunkedGrid<Slot> slots;
+	std::vector<int32_t> nextBox; //Next box on the board in the same cell as each box, -1 -> none
+
+	inline bool IsInside(int x, int y) const { return x >= 0 && y >= 0 && x < width && y < height; }
+
+	void Link(int32_t box, Slot& slot) {
+		int32_t* link = &slot.firstBox;
+		while (*link >= 0 && *link < box) link = &nextBox[*link];
+
+		nextBox[box] = *link;
+		*link = box;
+	}
+
+	void Unlink(int32_t box, Slot& slot) {
+		int32_t* link = &slot.firstBox;
+		while (*link >= 0 && *link != box) link = &nextBox[*link];
+
+		if (*link == box) *link = nextBox[box];
+		nextBox[box] = -1;
+	}
+public:
+	Occupancy() {
+		width = height = 0;
+	}
+
+	//Empties the grid and sizes it for a level with nBoxCount boxes
+	void Reset(uint32_t newWidth, uint32_t newHeight, std::size_t nBoxCount) {
+		width = (int)newWidth;
+		height = (int)newHeight;
+
+		slots.Reset(newWidth, newHeight, { -1, -1, 0, 0 });
+		nextBox.assign(nBoxCount, -1);
+	}
+
+	void AddBox(int32_t box, int x, int y, bool isOnBoard) {
+		if (!IsInside(x, y)) return;
+
+		Slot& slot = slots.At(x, y);
+		slot.nBoxes++;
+		if (isOnBoard) Link(box, slot);
+	}
+
+	void RemoveBox(int32_t box, int x, int y, bool isOnBoard) {
+		if (!IsInside(x, y)) return;
+
+		Slot& slot = slots.At(x, y);
+		slot.nBoxes--;
+		if (isOnBoard) Unlink(box, slot);
+	}
+
+	void MoveBox(int32_t box, int fromX, int fromY, int toX, int toY) {
+		RemoveBox(box, fromX, fromY, true);
+		AddBox(box, toX, toY, true);
+	}
+
+	//A box that filled a hole stays in its cell but no longer blocks or gets pushed
+	void TakeOffBoard(int32_t box, int x, int y) {
+		if (IsInside(x, y)) Unlink(box, slots.At(x, y));
+	}
+
+	void AddAgent(int x, int y) {
+		if (IsInside(x, y)) slots.At(x, y).nAgents++;
+	}
+
+	void RemoveAgent(int x, int y) {
+		if (IsInside(x, y)) slots.At(x, y).nAgents--;
+	}
+
+	void MoveAgent(int fromX, int fromY, int toX, int toY) {
+		RemoveAgent(fromX, fromY);
+		AddAgent(toX, toY);
+	}
+
+	void SetTile(int32_t tile, int x, int y) {
+		if (IsInside(x, y)) slots.At(x, y).tile = tile;
+	}
+
+	inline int32_t GetFirstBox(int x, int y) const { return IsInside(x, y) ? slots.Get(x, y).firstBox : -1; }
+	inline int32_t GetNextBox(int32_t box) const { return nextBox[box]; }
+	inline bool GetIsBoxOnBoard(int x, int y) const { return GetFirstBox(x, y) >= 0; }
+	inline bool GetIsCovered(int x, int y) const { return IsInside(x, y) && slots.Get(x, y).nBoxes > 0; }
+	inline bool GetIsAgent(int x, int y) const { return IsInside(x, y) && slots.Get(x, y).nAgents > 0; }
+	inline int32_t GetTile(int x, int y) const { return IsInside(x, y) ? slots.Get(x, y).tile : -1; }
+	inline std::size_t GetMemoryUse() const { return slots.GetMemoryUse() + nextBox.size() * sizeof(int32_t); }
+};
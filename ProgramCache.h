@@ -0,0 +1,150 @@
+#pragma once
+#include "Interpreter.h"
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+
+//Result of playing a program on a level
+struct RunOutcome {
+	bool isWin, isAborted;
+	int64_t nMoves, nSteps; //nMoves -> move counter at the end, nSteps -> moves the program played
+};
+
+//How the players of a level share a run, the same program may end differently in each
+enum class PlayMode : uint8_t {
+	Coop, //The run is won when every player ends it on a win tile
+	Race  //The first player whose program ends on a win tile wins & ends the run for all
+};
+
+//Compiled programs and their outcomes per level, keyed by a hash of the program text
+//with whitespace, empty lines and comments stripped, so resubmissions are never compiled or simulated twice
+//Each entry keeps that normalized text too, a program only matches an entry whose text is its own
+//Safe to share between threads, compiling happens outside the lock
+class ProgramCache {
+private:
+	struct ProgramEntry {
+		std::string text;
+		std::shared_ptr<const Program> program;
+	};
+
+	struct OutcomeEntry {
+		std::string text;
+		int levelId;
+		PlayMode mode;
+		RunOutcome outcome;
+	};
+
+	std::unordered_map<uint64_t, ProgramEntry> programs;
+	std::unordered_map<uint64_t, OutcomeEntry> outcomes;
+	std::size_t maxEntries;
+	mutable std::mutex mutex;
+
+	ProgramCache() {
+		maxEntries = 1 << 16;
+	}
+
+	static inline uint64_t Mix(uint64_t hash, uint8_t byte) {
+		return (hash ^ byte) * 0x100000001B3ull;
+	}
+
+	static inline uint64_t OutcomeKey(uint64_t programHash, int levelId, PlayMode mode) {
+		return programHash ^ (((uint64_t)(uint32_t)levelId << 1 | (uint64_t)mode) * 0x9E3779B97F4A7C15ull);
+	}
+public:
+	static ProgramCache& Get() {
+		static ProgramCache cache;
+		return cache;
+	}
+
+	//Tokens of every non-empty line, each followed by 0x1F & each line by 0x1E
+	static std::string Normalize(const std::vector<std::string>& strings) {
+		std::string text;
+
+		for (const auto& line : strings) {
+			Token tokens[maxTokens];
+			std::size_t nTokens = Tokenize(line, tokens);
+			if (nTokens == 0) continue;
+
+			for (std::size_t i = 0; i < nTokens; i++) {
+				text += tokens[i].text;
+				text += '\x1F';
+			}
+			text += '\x1E';
+		}
+
+		return text;
+	}
+
+	//FNV-1a over the normalized text
+	static uint64_t Hash(const std::string& text) {
+		uint64_t hash = 0xCBF29CE484222325ull;
+		for (char c : text) hash = Mix(hash, (uint8_t)c);
+		return hash;
+	}
+
+	//Same as hashing the normalized text, without building it
+	static uint64_t Hash(const std::vector<std::string>& strings) {
+		uint64_t hash = 0xCBF29CE484222325ull;
+
+		for (const auto& line : strings) {
+			Token tokens[maxTokens];
+			std::size_t nTokens = Tokenize(line, tokens);
+			if (nTokens == 0) continue;
+
+			for (std::size_t i = 0; i < nTokens; i++) {
+				for (char c : tokens[i].text) hash = Mix(hash, (uint8_t)c);
+				hash = Mix(hash, 0x1F); //Word separator
+			}
+			hash = Mix(hash, 0x1E); //Line separator
+		}
+
+		return hash;
+	}
+
+	std::shared_ptr<const Program> Compile(const std::vector<std::string>& strings, uint64_t hash) {
+		std::string text = Normalize(strings);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			auto it = programs.find(hash);
+			if (it != programs.end() && it->second.text == text) return it->second.program;
+		}
+
+		auto program = std::make_shared<const Program>(Program::Compile(strings));
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (programs.size() >= maxEntries) programs.clear();
+
+		//Another thread may have compiled the same program meanwhile, keep the first
+		//A different program with the same hash gives its entry up to this one
+		ProgramEntry& entry = programs[hash];
+		if (entry.program == nullptr || entry.text != text) entry = { std::move(text), std::move(program) };
+		return entry.program;
+	}
+
+	std::shared_ptr<const Program> Compile(const std::vector<std::string>& strings) {
+		return Compile(strings, Hash(strings));
+	}
+
+	//text -> the program's normalized text, programHash -> its hash, mode -> how the level's players shared the run
+	void StoreOutcome(const std::string& text, uint64_t programHash, int levelId, PlayMode mode, const RunOutcome& outcome) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (outcomes.size() >= maxEntries) outcomes.clear();
+		outcomes[OutcomeKey(programHash, levelId, mode)] = { text, levelId, mode, outcome };
+	}
+
+	//Copies the outcome out as another thread may clear the cache
+	bool FindOutcome(const std::string& text, uint64_t programHash, int levelId, PlayMode mode, RunOutcome& outcome) const {
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = outcomes.find(OutcomeKey(programHash, levelId, mode));
+		if (it == outcomes.end() || it->second.levelId != levelId || it->second.mode != mode || it->second.text != text) return false;
+
+		outcome = it->second.outcome;
+		return true;
+	}
+
+	void Clear() {
+		std::lock_guard<std::mutex> lock(mutex);
+		programs.clear();
+		outcomes.clear();
+	}
+};
@@ -0,0 +1,256 @@
+#pragma once
+#include "Simulation.h"
+#include <fstream>
+
+//A run stored compactly enough to attach to a support ticket: the program, the level it was played on
+//and a digest of the world after each move, re-simulating it must reproduce every digest and the outcome
+//File layout (little endian): "CARP", version byte, level index (u16), level digest (u64), program line count (u32),
+//each line as length (u16) & bytes, win & aborted flags (u8), moves (u64), steps (u64), digest count (u32), digests (u32 each)
+//Only the first maxDigests moves keep a digest, the rest of a long run is checked through its outcome
+class Replay {
+private:
+	static const uint8_t version = 2;
+
+	int levelIndex;
+	uint64_t levelDigest;
+	std::vector<std::string> strings;
+	RunOutcome outcome;
+	std::vector<uint32_t> digests;
+
+	static void Hash(uint64_t& hash, int64_t value) {
+		for (int i = 0; i < 8; i++) {
+			hash ^= (uint8_t)(value >> (i * 8));
+			hash *= 1099511628211ull;
+		}
+	}
+
+	static void WriteBytes(std::ostream& writer, uint64_t value, int nBytes) {
+		for (int i = 0; i < nBytes; i++) writer.put((char)(uint8_t)(value >> (i * 8)));
+	}
+
+	static bool ReadBytes(std::istream& reader, uint64_t& value, int nBytes) {
+		value = 0;
+		for (int i = 0; i < nBytes; i++) {
+			int c = reader.get();
+			if (c == EOF) return false;
+			value |= (uint64_t)(uint8_t)c << (i * 8);
+		}
+		return true;
+	}
+
+	//Plays the program move by move, calling onMove after each of the first nDigests moves, then to the end at full speed
+	template<typename F>
+	static RunOutcome Play(const Level& level, const ItemMap& itemMap, const std::string& opponentPath,
+		const std::vector<std::string>& strings, std::size_t nDigests, F onMove) {
+		World world;
+		world.Load(level, itemMap, opponentPath);
+		world.Run(strings);
+
+		WorldState state;
+		std::size_t nMoves = 0;
+		while (world.GetIsRun() && nMoves < nDigests) {
+			if (world.Step(UINT32_MAX) != Yield::Move) continue;
+
+			world.GetState(state);
+			if (!onMove(nMoves++, Digest(state))) return world.GetResult().outcome;
+		}
+
+		world.FastForward();
+		return world.GetResult().outcome;
+	}
+public:
+	static const std::size_t maxDigests = 1 << 12;
+	static const std::size_t maxLines = 1 << 16; //A longer program means the file is not a replay
+
+	Replay() {
+		levelIndex = 0;
+		levelDigest = 0;
+		outcome = { false, false, 0, 0 };
+	}
+
+	//32 bit digest of everything in a world that moves or changes
+	static uint32_t Digest(const WorldState& state) {
+		uint64_t hash = 14695981039346656037ull;
+		Hash(hash, state.playerCell.x);
+		Hash(hash, state.playerCell.y);
+		Hash(hash, state.direction);
+
+		//Single player levels hash as they did before levels had several players
+		for (const auto& [cell, direction] : state.otherPlayers) {
+			Hash(hash, cell.x);
+			Hash(hash, cell.y);
+			Hash(hash, direction);
+		}
+
+		for (const auto& [cell, isValue] : state.boxes) {
+			Hash(hash, cell.x);
+			Hash(hash, cell.y);
+			Hash(hash, isValue);
+		}
+		for (bool isActive : state.toggles) Hash(hash, isActive);
+		for (const auto& cell : state.filledHoles) {
+			Hash(hash, cell.x);
+			Hash(hash, cell.y);
+		}
+
+		Hash(hash, state.opponentCell.x);
+		Hash(hash, state.opponentCell.y);
+		Hash(hash, state.opponentIndex);
+		Hash(hash, state.opponentDirection);
+
+		return (uint32_t)(hash ^ (hash >> 32));
+	}
+
+	//Digest of a level's terrain, items & opponent path, so a replay of an edited level is told apart from a desync
+	static uint64_t Digest(const Level& level, const ItemMap& itemMap, const std::string& opponentPath) {
+		uint64_t hash = 14695981039346656037ull;
+
+		for (const Level* map : { &level, &itemMap }) {
+			Hash(hash, map->GetWidth());
+			Hash(hash, map->GetHeight());
+			for (uint32_t i = 0; i < map->GetHeight(); i++) {
+				for (uint32_t j = 0; j < map->GetWidth(); j++) Hash(hash, map->GetCharacter(j, i));
+			}
+		}
+		for (char c : opponentPath) Hash(hash, c);
+
+		return hash;
+	}
+
+	//Plays a program on a level and keeps what is needed to check the run again
+	static Replay Record(const Level& level, const ItemMap& itemMap, const std::string& opponentPath, int levelIndex,
+		const std::vector<std::string>& strings) {
+		Replay replay;
+		replay.levelIndex = levelIndex;
+		replay.levelDigest = Digest(level, itemMap, opponentPath);
+		replay.strings = strings;
+
+		replay.outcome = Play(level, itemMap, opponentPath, strings, maxDigests, [&](std::size_t, uint32_t digest) {
+			replay.digests.push_back(digest);
+			return true;
+		});
+
+		return replay;
+	}
+
+	//Starts a replay of a run played elsewhere, such as in the game, its moves are added while they are played
+	void Start(const Level& level, const ItemMap& itemMap, const std::string& opponentPath, int newLevelIndex,
+		const std::vector<std::string>& newStrings) {
+		levelIndex = newLevelIndex;
+		levelDigest = Digest(level, itemMap, opponentPath);
+		strings = newStrings;
+		outcome = { false, false, 0, 0 };
+		digests.clear();
+	}
+
+	//The world after the run's next move, moves past maxDigests are only checked through the outcome
+	void AddMove(const WorldState& state) {
+		if (digests.size() < maxDigests) digests.push_back(Digest(state));
+	}
+
+	//Keeps the digests of the first n moves, such as after the run stepped back
+	void Truncate(std::size_t n) {
+		if (n < digests.size()) digests.resize(n);
+	}
+
+	void SetOutcome(const RunOutcome& newOutcome) { outcome = newOutcome; }
+
+	//Re-simulates the replay on its level, on a mismatch message says where the run went apart
+	bool Verify(const Level& level, const ItemMap& itemMap, const std::string& opponentPath, std::string& message) const {
+		if (Digest(level, itemMap, opponentPath) != levelDigest) {
+			message = "level " + std::to_string(levelIndex) + " differs from the one recorded";
+			return false;
+		}
+
+		std::size_t nMatched = 0;
+		RunOutcome played = Play(level, itemMap, opponentPath, strings, digests.size(), [&](std::size_t i, uint32_t digest) {
+			if (digest != digests[i]) return false;
+			nMatched++;
+			return true;
+		});
+
+		if (nMatched < digests.size()) {
+			message = "state differs after move " + std::to_string(nMatched + 1);
+			return false;
+		}
+
+		if (played.isWin != outcome.isWin || played.isAborted != outcome.isAborted ||
+			played.nMoves != outcome.nMoves || played.nSteps != outcome.nSteps) {
+			message = "outcome differs";
+			return false;
+		}
+
+		message = "ok";
+		return true;
+	}
+
+	bool Save(const std::string& fileName) const {
+		std::ofstream writer(fileName, std::ios::binary);
+		if (!writer.is_open()) return false;
+
+		writer.write("CARP", 4);
+		WriteBytes(writer, version, 1);
+		WriteBytes(writer, (uint64_t)levelIndex, 2);
+		WriteBytes(writer, levelDigest, 8);
+
+		WriteBytes(writer, strings.size(), 4);
+		for (const auto& line : strings) {
+			std::size_t n = std::min<std::size_t>(line.size(), UINT16_MAX);
+			WriteBytes(writer, n, 2);
+			writer.write(line.data(), n);
+		}
+
+		WriteBytes(writer, (uint64_t)outcome.isWin | (uint64_t)outcome.isAborted << 1, 1);
+		WriteBytes(writer, (uint64_t)outcome.nMoves, 8);
+		WriteBytes(writer, (uint64_t)outcome.nSteps, 8);
+
+		WriteBytes(writer, digests.size(), 4);
+		for (uint32_t digest : digests) WriteBytes(writer, digest, 4);
+
+		return (bool)writer;
+	}
+
+	bool Load(const std::string& fileName) {
+		std::ifstream reader(fileName, std::ios::binary);
+		if (!reader.is_open()) return false;
+
+		char magic[4];
+		uint64_t value;
+		if (!reader.read(magic, 4) || std::string(magic, 4) != "CARP") return false;
+		if (!ReadBytes(reader, value, 1) || value != version) return false;
+
+		if (!ReadBytes(reader, value, 2)) return false;
+		levelIndex = (int)value;
+		if (!ReadBytes(reader, levelDigest, 8)) return false;
+
+		if (!ReadBytes(reader, value, 4) || value > maxLines) return false;
+		strings.assign((std::size_t)value, "");
+		for (auto& line : strings) {
+			if (!ReadBytes(reader, value, 2)) return false;
+			line.resize((std::size_t)value);
+			if (value > 0 && !reader.read(&line[0], (std::streamsize)value)) return false;
+		}
+
+		if (!ReadBytes(reader, value, 1)) return false;
+		outcome.isWin = value & 1;
+		outcome.isAborted = (value >> 1) & 1;
+		if (!ReadBytes(reader, value, 8)) return false;
+		outcome.nMoves = (int64_t)value;
+		if (!ReadBytes(reader, value, 8)) return false;
+		outcome.nSteps = (int64_t)value;
+
+		if (!ReadBytes(reader, value, 4) || value > maxDigests) return false;
+		digests.resize((std::size_t)value);
+		for (auto& digest : digests) {
+			if (!ReadBytes(reader, value, 4)) return false;
+			digest = (uint32_t)value;
+		}
+
+		return true;
+	}
+
+	inline int GetLevelIndex() const { return levelIndex; }
+	inline const std::vector<std::string>& GetStrings() const { return strings; }
+	inline const RunOutcome& GetOutcome() const { return outcome; }
+	inline std::size_t GetDigestCount() const { return digests.size(); }
+};
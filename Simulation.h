@@ -0,0 +1,994 @@
+#pragma once
+#include "Board.h"
+#include "Interpreter.h"
+#include "ProgramCache.h"
+#include "MoveTrace.h"
+#include "CycleDetector.h"
+#include "Occupancy.h"
+#include <algorithm>
+
+//Game rules without a window: entities live on grid cells and the renderer only reads them
+
+struct Cell {
+	int x, y;
+
+	inline Cell operator+(const Cell& other) const { return { x + other.x, y + other.y }; }
+	inline Cell operator*(int n) const { return { x * n, y * n }; }
+	inline bool operator==(const Cell& other) const { return x == other.x && y == other.y; }
+	inline bool operator!=(const Cell& other) const { return !(*this == other); }
+};
+
+class Box {
+private:
+	Cell resetPosition, position;
+	bool isValue;
+public:
+	Box() {}
+	Box(const Cell& pos)
+		: resetPosition(pos), position(pos) {
+		isValue = true;
+	}
+
+	void Logic(const Board& board, const Cell& playerPos, const Cell& direction) {
+		if (isValue) {
+			if (position == playerPos) {
+				Cell next = position + direction;
+				if (board.GetTerrain(next.x, next.y) == '#') {
+					position = next;
+				}
+			}
+		}
+	}
+
+	void Reset() {
+		position = resetPosition;
+		isValue = true;
+	}
+	inline bool GetIsValue() const { return isValue; }
+	void SetIsValue(bool state) { isValue = state; }
+	void SetPosition(const Cell& pos) { position = pos; }
+	inline Cell GetPosition() const { return position; }
+};
+
+class ToggleTile {
+private:
+	Cell position;
+	bool isTileActive;
+public:
+	ToggleTile() {}
+	ToggleTile(const Cell& pos)
+		: position(pos) {
+		isTileActive = false;
+	}
+
+	//Pressed while any box is in its cell, even one that left the board
+	void Logic(const Occupancy& occupancy) {
+		isTileActive = occupancy.GetIsCovered(position.x, position.y);
+	}
+
+	void Reset() { isTileActive = false; }
+	void SetPosition(const Cell& pos) { position = pos; }
+	inline bool GetIsTileActive() const { return isTileActive; }
+	void SetIsTileActive(bool isActive) { isTileActive = isActive; }
+	inline Cell GetPosition() const { return position; }
+};
+
+//Patrols a path of n steps out and back, so its cells repeat every 2n steps
+//Every cell of one period is precomputed and only the phase in it is kept, a step into a player's cell is blocked
+//and leaves the phase where it is, so the cell after any number of free steps is a table lookup
+class Opponent {
+private:
+	Cell resetPos;
+	std::vector<Cell> movePositions;
+	std::vector<Cell> patrol; //Cell at each phase, phases below n walk the path out & the rest walk it back
+	int phase;
+
+	void BuildPatrol() {
+		const int n = (int)movePositions.size();
+
+		std::vector<Cell> path = { resetPos };
+		for (const auto& step : movePositions) path.push_back(path.back() + step);
+
+		patrol.clear();
+		for (int i = 0; i < std::max(2 * n, 1); i++) {
+			patrol.push_back(path[i <= n ? i : 2 * n - i]);
+		}
+	}
+public:
+	Opponent() {
+		resetPos = { -1, -1 };
+		phase = 0;
+		BuildPatrol();
+	}
+
+	void SetResetPos(const Cell& initPos) {
+		resetPos = initPos;
+		phase = 0;
+		BuildPatrol();
+	}
+
+	void Reset() {
+		phase = 0;
+	}
+
+	void ClearMovePositions() {
+		movePositions.clear();
+		BuildPatrol();
+	}
+
+	//The cell follows from the index & direction along the path
+	void SetState(int newIndex, int newDirection) {
+		const int n = (int)movePositions.size();
+		phase = n == 0 ? 0 : (newDirection > 0 ? newIndex : 2 * n - 1 - newIndex);
+	}
+
+	//Patrol path as a string of directions (0 -> Right, 1 -> Down, 2 -> Left, 3 -> Up)
+	void SetPath(const std::string& directions) {
+		movePositions.clear();
+
+		for (char c : directions) {
+			switch (c) {
+			case '0': //Right
+				movePositions.push_back({ 1, 0 });
+				break;
+			case '1': //Down
+				movePositions.push_back({ 0, 1 });
+				break;
+			case '2': //Left
+				movePositions.push_back({ -1, 0 });
+				break;
+			case '3': //Up
+				movePositions.push_back({ 0, -1 });
+				break;
+			}
+		}
+
+		BuildPatrol();
+	}
+
+	void Move(const Occupancy& occupancy) {
+		int next = (phase + 1) % GetPeriod();
+		if (!occupancy.GetIsAgent(patrol[next].x, patrol[next].y)) phase = next;
+	}
+
+	inline Cell GetPosition() const { return patrol[phase]; }
+	inline int GetPeriod() const { return (int)patrol.size(); }
+	inline int GetPhase() const { return phase; }
+	inline int GetIndex() const { return phase < (int)movePositions.size() ? phase : GetPeriod() - 1 - phase; }
+	inline int GetDirection() const { return phase < (int)movePositions.size() || movePositions.empty() ? 1 : -1; }
+};
+
+//Progress of the player through a run, enough to take the run back to it
+struct PlayerState {
+	Interpreter::State interpreter;
+	std::size_t nMoves, nCounted, nPickedItems;
+	bool isIndex, isWin, isSpiked;
+};
+
+class Player {
+private:
+	Cell resetPlayerPos, playerPos;
+	Interpreter interpreter;
+	MoveTrace trace; //Moves played since the last reset
+	std::vector<Cell> pickedItems; //Items picked up during the run, in order
+	uint64_t programHash; //Normalized text hash of the loaded program
+	int direction;
+	bool isIndex, isWin; //isIndex -> program has run out of moves & isWin -> has player won a level
+	bool isSpiked;		 //A spike ended the run
+
+public:
+	Player() {
+		resetPlayerPos = playerPos = { 0, 0 };
+		programHash = 0;
+		direction = 0;
+		isIndex = false;
+		isWin = false;
+		isSpiked = false;
+	}
+
+	//Is the cell in front of the player walkable and free of boxes, other players and the opponent right now
+	bool IsFdEmpty(const Occupancy& occupancy, const Opponent& o, const Board& board, int facing) const {
+		Cell cell = playerPos + Cell{ directionX[facing], directionY[facing] };
+
+		if (board.GetTerrain(cell.x, cell.y) != '#') return false;
+		if (occupancy.GetIsBoxOnBoard(cell.x, cell.y)) return false;
+		if (occupancy.GetIsAgent(cell.x, cell.y)) return false;
+
+		return o.GetPosition() != cell;
+	}
+
+	//Pulls the next move from the program within the instruction budget and plays it
+	Yield Move(std::vector<Box>& boxes, Occupancy& occupancy, Opponent& o, Board& board, std::vector<Cell>& filledHoles,
+		uint32_t instructionBudget) {
+		int moveDirection = 0;
+		Yield yield = interpreter.Next(moveDirection, [&](int facing) {
+			return IsFdEmpty(occupancy, o, board, facing);
+		}, instructionBudget);
+
+		if (yield != Yield::Move) return yield;
+
+		bool isCounted = Play(moveDirection, interpreter.GetDirection(), boxes, occupancy, o, board, filledHoles);
+		trace.Push(moveDirection, direction, isCounted);
+
+		return yield;
+	}
+
+	//Plays one move in an absolute direction, returns whether the move counter counts it
+	//Another player in the way blocks the move like the opponent does, as does one in the cell a box would be pushed to
+	bool Play(int moveDirection, int facing, std::vector<Box>& boxes, Occupancy& occupancy, const Opponent& o, Board& board,
+		std::vector<Cell>& filledHoles) {
+		direction = facing;
+		Cell movePosition = { directionX[moveDirection], directionY[moveDirection] };
+
+		bool isMove = true, isCounted = false;
+
+		//New Position of player in level & the cell a box in front of it is pushed to
+		Cell newPlayerPos = playerPos + movePosition;
+		Cell boxPos = newPlayerPos + movePosition;
+
+		//Boxes on the board in the cell walked into, in index order as the first to fill a hole leaves floor for the rest
+		for (int32_t i = occupancy.GetFirstBox(newPlayerPos.x, newPlayerPos.y); i >= 0;) {
+			int32_t next = occupancy.GetNextBox(i);
+			char boxChar = board.GetTerrain(boxPos.x, boxPos.y);
+
+			if (boxChar == '.') {
+				board.FillHole(boxPos.x, boxPos.y);
+				filledHoles.push_back(boxPos);
+
+				boxes[i].SetIsValue(false);
+				occupancy.TakeOffBoard(i, newPlayerPos.x, newPlayerPos.y);
+				isMove = false;
+			}
+			if (boxChar != '#' || occupancy.GetIsAgent(boxPos.x, boxPos.y)) {
+				isMove = false;
+			}
+
+			i = next;
+		}
+
+		if (newPlayerPos == o.GetPosition() || occupancy.GetIsAgent(newPlayerPos.x, newPlayerPos.y)) {
+			isMove = false;
+			isCounted = true;
+		}
+
+		if (isMove && board.GetTerrain(newPlayerPos.x, newPlayerPos.y) == '#') {
+			isCounted = true;
+			playerPos = newPlayerPos;
+		}
+
+		return isCounted;
+	}
+
+	//Drops whole periods of the innermost loop found by the cycle detector, the trace & instruction count still count them
+	//Only the periods that fit under the instruction limit are dropped, the rest are played so the run aborts where stepping would
+	void SkipPeriods(const CycleDetector::Skip& skip) {
+		int32_t nPeriods = skip.nPeriods;
+		if (skip.nPeriodInstructions > 0) {
+			uint64_t room = interpreter.GetInstructionLimit() - std::min(interpreter.GetInstructionCount(), interpreter.GetInstructionLimit());
+			nPeriods = (int32_t)std::min<uint64_t>((uint64_t)nPeriods, room / skip.nPeriodInstructions);
+		}
+		if (nPeriods <= 0) return;
+
+		interpreter.SkipIterations(skip.period * nPeriods, skip.nPeriodInstructions * (uint64_t)nPeriods);
+		trace.Skip(skip.nPeriodSteps, skip.nPeriodCounted, (std::size_t)nPeriods);
+	}
+
+	void SetIsLoopBreak(bool state) { interpreter.SetIsLoopBreak(state); }
+
+	void Run(const std::vector<std::string>& strings) {
+		programHash = ProgramCache::Hash(strings);
+		Run(ProgramCache::Get().Compile(strings, programHash), direction);
+	}
+
+	//Runs a compiled program from the current cell, the trace starts over
+	void Run(std::shared_ptr<const Program> program, int startDirection) {
+		interpreter.Load(std::move(program), startDirection);
+		trace.Clear();
+		pickedItems.clear();
+		isIndex = false;
+		isSpiked = false;
+	}
+
+	//isAllTilesActive -> every toggle tile of the level is pressed, or it has none
+	void Logic(Board& board, bool& isRun, bool isAllTilesActive) {
+		auto [x, y] = playerPos;
+		uint32_t w = board.GetWidth(), h = board.GetHeight();
+
+		if (x < 0) x = 0;
+		if (y < 0) y = 0;
+		if (x > (int)(w - 1)) x = (int)(w - 1);
+		if (y > (int)(h - 1)) y = (int)(h - 1);
+
+		isWin = false;
+
+		switch (board.GetItem(x, y)) {
+		case 'A':
+			board.PickItem(x, y);
+			pickedItems.push_back({ x, y });
+			break;
+		case 'S':
+			interpreter.Stop();
+			Reset();
+			isSpiked = true;
+			break;
+		case 'W':
+			if (isAllTilesActive) isWin = true;
+			break;
+		}
+
+		if (interpreter.IsFinished()) {
+			isRun = false;
+			isIndex = true;
+		}
+	}
+
+	void SetPosition(const Cell& pos) {
+		playerPos = pos;
+		resetPlayerPos = pos;
+	}
+
+	//Moves the player without touching its start cell or the program
+	void SetState(const Cell& pos, int newDirection) {
+		playerPos = pos;
+		direction = newDirection;
+	}
+
+	void GetRunState(PlayerState& state) const {
+		interpreter.GetState(state.interpreter);
+		state.nMoves = trace.GetSize();
+		state.nCounted = trace.GetNCounted();
+		state.nPickedItems = pickedItems.size();
+		state.isIndex = isIndex;
+		state.isWin = isWin;
+		state.isSpiked = isSpiked;
+	}
+
+	//Takes the run back to a state from earlier in it, items picked up since go back on the item map
+	void SetRunState(const PlayerState& state, Board& board) {
+		interpreter.SetState(state.interpreter);
+		trace.Truncate(state.nMoves, state.nCounted);
+
+		while (pickedItems.size() > state.nPickedItems) {
+			board.DropItem(pickedItems.back().x, pickedItems.back().y, 'A');
+			pickedItems.pop_back();
+		}
+
+		isIndex = state.isIndex;
+		isWin = state.isWin;
+		isSpiked = state.isSpiked;
+	}
+
+	void ResetWin() { isWin = false; }
+	void Reset() {
+		trace.Clear();
+		isIndex = false;
+		ResetWin();
+		SetPosition(resetPlayerPos);
+		direction = 0;
+	}
+
+	inline int64_t GetNMoves() const { return (int64_t)trace.GetNCounted(); }
+	inline bool GetIsWin() const { return isWin; }
+	inline bool GetIsIndex() const { return isIndex; }
+	inline bool GetIsSpiked() const { return isSpiked; }
+	inline bool GetIsAborted() const { return interpreter.IsAborted(); }
+	inline uint64_t GetInstructionCount() const { return interpreter.GetInstructionCount(); }
+	inline Cell GetPosition() const { return playerPos; }
+	inline int GetDirection() const { return direction; }
+
+	inline const Interpreter& GetInterpreter() const { return interpreter; }
+	inline const MoveTrace& GetTrace() const { return trace; }
+	inline uint64_t GetProgramHash() const { return programHash; }
+
+	Cell GetCurrentMovePosition() const {
+		if (trace.GetRunCount() == 0) return {};
+
+		int moveDirection = MoveTrace::GetMoveDirection(trace.Back());
+		return { directionX[moveDirection], directionY[moveDirection] };
+	}
+};
+
+//Everything in a world that moves or changes while a program plays
+struct WorldState {
+	Cell playerCell;
+	int direction;
+	std::vector<std::pair<Cell, int>> otherPlayers; //Cell & direction of every player after the first
+	std::vector<std::pair<Cell, bool>> boxes;		 //Cell of each box & whether it is still on the board
+	std::vector<bool> toggles;
+	std::vector<Cell> filledHoles; //Holes boxes were pushed into, in the order they were filled
+	Cell opponentCell;
+	int opponentIndex, opponentDirection;
+};
+
+//A run in progress: the world and how far each player's program got
+struct RunState {
+	WorldState world;
+	std::vector<PlayerState> players;
+	std::size_t currentPlayer;
+	bool isRun, isTickMoved;
+};
+
+//Final state of a run played to the end
+struct RunResult {
+	RunOutcome outcome;
+	Cell playerCell;
+	int direction;
+	std::vector<std::pair<Cell, bool>> boxes; //Cell of each box & whether it is still on the board
+	std::vector<bool> toggles;				  //Is each toggle tile pressed
+};
+
+//Rules of a level in play: the board and the entities on it, advanced one move at a time
+//A level may place several players, each running its own program, they all play one move per tick in index order
+//and each sees the moves of those before it, so two players going for the same cell resolve the same way every time
+class World {
+public:
+	typedef PlayMode Mode;
+private:
+	Board board;
+
+	std::vector<Player> players;
+	Opponent opponent;
+
+	std::vector<Box> boxes;
+	std::vector<ToggleTile> tiles;
+
+	Occupancy occupancy;
+	std::vector<int32_t> pushedBoxes;
+	std::vector<Cell> filledHoles; //Holes boxes were pushed into, in the order they were filled
+	int nActiveTiles;
+	bool isTilesSynced; //false -> toggles were set without looking at the boxes, the next answer checks them all
+
+	CycleDetector cycleDetector;
+	std::vector<int32_t> cycleState;
+
+	uint64_t programHash; //Normalized text hash of the whole program, every player's part included
+	Mode mode;
+	std::size_t currentPlayer; //Next player to move in the current tick
+	bool isTickMoved;		   //A player moved in the current tick
+
+	bool isRun, isToggleTileInLevel, isOpponentInLevel;
+
+	//Everything the rest of the run depends on except the counter of the loop at its back edge
+	void GetCycleState(std::vector<int32_t>& state) const {
+		const Player& player = players[0];
+		const Interpreter& interpreter = player.GetInterpreter();
+		const std::vector<int32_t>& counters = interpreter.GetLoopCounters();
+
+		state.clear();
+		state.push_back(interpreter.GetPc());
+		state.push_back(interpreter.GetDirection());
+		state.insert(state.end(), counters.begin(), counters.end() - 1);
+
+		state.push_back(player.GetPosition().x);
+		state.push_back(player.GetPosition().y);
+		state.push_back(player.GetDirection());
+
+		//A box leaves the board when it fills a hole, so equal boxes also mean equal terrain
+		for (const auto& box : boxes) {
+			state.push_back(box.GetPosition().x);
+			state.push_back(box.GetPosition().y);
+			state.push_back(box.GetIsValue());
+		}
+
+		for (const auto& tile : tiles) {
+			state.push_back(tile.GetIsTileActive());
+		}
+
+		if (isOpponentInLevel) {
+			state.push_back(opponent.GetPosition().x);
+			state.push_back(opponent.GetPosition().y);
+			state.push_back(opponent.GetIndex());
+			state.push_back(opponent.GetDirection());
+		}
+	}
+
+	//Adds every box to the occupancy grid or takes them all out
+	void PlaceBoxes(bool isPlaced) {
+		for (std::size_t i = 0; i < boxes.size(); i++) {
+			Cell cell = boxes[i].GetPosition();
+			if (isPlaced) occupancy.AddBox((int32_t)i, cell.x, cell.y, boxes[i].GetIsValue());
+			else occupancy.RemoveBox((int32_t)i, cell.x, cell.y, boxes[i].GetIsValue());
+		}
+	}
+
+	void PlacePlayers(bool isPlaced) {
+		for (const auto& player : players) {
+			Cell cell = player.GetPosition();
+			if (isPlaced) occupancy.AddAgent(cell.x, cell.y);
+			else occupancy.RemoveAgent(cell.x, cell.y);
+		}
+	}
+
+	void UpdateTile(const Cell& cell) {
+		int32_t i = occupancy.GetTile(cell.x, cell.y);
+		if (i < 0) return;
+
+		bool wasActive = tiles[i].GetIsTileActive();
+		tiles[i].Logic(occupancy);
+		nActiveTiles += (int)tiles[i].GetIsTileActive() - (int)wasActive;
+	}
+
+	void SyncTiles() {
+		nActiveTiles = 0;
+		for (auto& tile : tiles) {
+			tile.Logic(occupancy);
+			nActiveTiles += tile.GetIsTileActive();
+		}
+		isTilesSynced = true;
+	}
+
+	//Jumps over the remaining iterations of a loop that came back to a state it was already in
+	void SkipCycles() {
+		GetCycleState(cycleState);
+
+		Player& player = players[0];
+		const MoveTrace& trace = player.GetTrace();
+		CycleDetector::Skip skip;
+		if (cycleDetector.Check(cycleState, player.GetInterpreter().GetLoopCounters().back(), trace.GetSize(), trace.GetNCounted(),
+			player.GetInstructionCount(), skip)) {
+			player.SkipPeriods(skip);
+		}
+	}
+
+	//Boxes in the cell a player moved into are pushed on along its move
+	void PushBoxes(const Cell& playerPos, int moveDirection) {
+		Cell playerDirection = { directionX[moveDirection], directionY[moveDirection] };
+
+		//Only boxes on the board in the player's cell can be pushed, copied out as pushing relinks them
+		pushedBoxes.clear();
+		for (int32_t i = occupancy.GetFirstBox(playerPos.x, playerPos.y); i >= 0; i = occupancy.GetNextBox(i)) {
+			pushedBoxes.push_back(i);
+		}
+
+		for (int32_t i : pushedBoxes) {
+			boxes[i].Logic(board, playerPos, playerDirection);
+			Cell cell = boxes[i].GetPosition();
+			if (cell != playerPos) occupancy.MoveBox(i, playerPos.x, playerPos.y, cell.x, cell.y);
+		}
+
+		//Tiles only change in the cells boxes left or entered, unless they were set by hand since the last check
+		//A level without boxes never touches its tiles
+		if (!boxes.empty() && isTilesSynced && !pushedBoxes.empty()) {
+			UpdateTile(playerPos);
+			UpdateTile(playerPos + playerDirection);
+		}
+	}
+
+	//Toggles & the opponent answering the moves of a tick
+	void EndTick() {
+		if (!boxes.empty() && !isTilesSynced) SyncTiles();
+
+		if (isOpponentInLevel) opponent.Move(occupancy);
+	}
+
+	//Plays one move of a player and keeps its cell in the occupancy grid
+	bool PlayMove(Player& player, int moveDirection, int facing) {
+		Cell from = player.GetPosition();
+		bool isCounted = player.Play(moveDirection, facing, boxes, occupancy, opponent, board, filledHoles);
+		Cell to = player.GetPosition();
+
+		if (to != from) occupancy.MoveAgent(from.x, from.y, to.x, to.y);
+		PushBoxes(to, moveDirection);
+
+		return isCounted;
+	}
+
+	//Splits a program into the part of each player at lines holding only "---", players past the last part run it again
+	std::vector<std::vector<std::string>> SplitProgram(const std::vector<std::string>& strings) const {
+		std::vector<std::vector<std::string>> parts(1);
+
+		if (players.size() > 1) {
+			for (const auto& line : strings) {
+				std::size_t first = line.find_first_not_of(" \t\r");
+				std::size_t last = line.find_last_not_of(" \t\r");
+				bool isSeparator = first != std::string::npos && line.compare(first, last - first + 1, "---") == 0;
+
+				if (isSeparator) parts.emplace_back();
+				else parts.back().push_back(line);
+			}
+		}
+		else {
+			parts[0] = strings;
+		}
+
+		return parts;
+	}
+
+	void StartRun() {
+		isRun = true;
+		currentPlayer = 0;
+		isTickMoved = false;
+		cycleDetector.Clear();
+	}
+public:
+	World() {
+		players.resize(1);
+		programHash = 0;
+		mode = Mode::Coop;
+		currentPlayer = 0;
+		isTickMoved = false;
+		isRun = false;
+		isToggleTileInLevel = false;
+		isOpponentInLevel = false;
+		nActiveTiles = 0;
+		isTilesSynced = false;
+	}
+
+	//The first 'P' of the item map (in row order) places the first player & each further one adds a player
+	void Load(const Level& level, const ItemMap& itemMap, const std::string& opponentPath) {
+		board.Load(level, itemMap);
+
+		boxes.clear();
+		tiles.clear();
+		filledHoles.clear();
+		players.resize(1);
+		players[0].Reset();
+		opponent.Reset();
+		opponent.ClearMovePositions();
+		opponent.SetResetPos({ -1, -1 });
+		isToggleTileInLevel = false;
+		isOpponentInLevel = false;
+		isRun = false;
+		currentPlayer = 0;
+		isTickMoved = false;
+
+		//Chunks of the item map never painted hold its background only, which places nothing unless it is an entity
+		const ChunkedGrid<char>& itemCells = itemMap.GetCells();
+		const char background = itemCells.GetFill();
+		const bool isBackgroundEmpty = background != 'P' && background != 'B' && background != 'O' && background != 'T';
+
+		bool isPlayerPlaced = false;
+		for (uint32_t i = 1; i < itemMap.GetHeight() - 1; i++) {
+			for (uint32_t j = 1; j < itemMap.GetWidth() - 1; j++) {
+				if (isBackgroundEmpty && !itemCells.GetIsPainted(j, i)) {
+					j |= ChunkedGrid<char>::chunkSize - 1;
+					continue;
+				}
+
+				char c = itemMap.GetCharacter(j, i);
+				Cell cell = { (int)j, (int)i };
+
+				switch (c) {
+				case 'P': //Player Position
+					if (isPlayerPlaced) players.emplace_back();
+					players.back().SetPosition(cell);
+					isPlayerPlaced = true;
+					board.SetItem(j, i, '#');
+					break;
+				case 'B': //Box Position
+					boxes.push_back(Box(cell));
+					board.SetItem(j, i, '#');
+					break;
+				case 'O': //Opponent Position
+					opponent.SetResetPos(cell);
+					board.SetItem(j, i, '#');
+					isOpponentInLevel = true;
+					break;
+				case 'T': //ToggleTile Position
+					tiles.push_back(ToggleTile(cell));
+					board.SetItem(j, i, '#');
+					board.SetFlag(j, i, Board::ToggleTile);
+					isToggleTileInLevel = true;
+					break;
+				}
+			}
+		}
+
+		if (isOpponentInLevel) opponent.SetPath(opponentPath);
+
+		occupancy.Reset(board.GetWidth(), board.GetHeight(), boxes.size());
+		PlaceBoxes(true);
+		PlacePlayers(true);
+		for (std::size_t i = 0; i < tiles.size(); i++) {
+			occupancy.SetTile((int32_t)i, tiles[i].GetPosition().x, tiles[i].GetPosition().y);
+		}
+		nActiveTiles = 0;
+		isTilesSynced = false;
+	}
+
+	//With several players the program holds the part of each, separated by lines of "---"
+	void Run(const std::vector<std::string>& strings) {
+		StartRun();
+		programHash = ProgramCache::Hash(strings);
+
+		std::vector<std::vector<std::string>> parts = SplitProgram(strings);
+		for (std::size_t i = 0; i < players.size(); i++) {
+			players[i].Run(parts[std::min(i, parts.size() - 1)]);
+		}
+	}
+
+	//Every player runs the same compiled program
+	void Run(std::shared_ptr<const Program> program, int startDirection) {
+		StartRun();
+		programHash = 0;
+
+		for (auto& player : players) player.Run(program, startDirection);
+	}
+
+	//Plays the programs up to the next tick in which a player moved and the entities' answer to it
+	//A program that runs out of budget or reaches a loop's back edge hands back Pending or Loop and the tick
+	//goes on from the same player on the next call
+	Yield Step(uint32_t instructionBudget) {
+		const uint64_t start = GetInstructionCount();
+
+		for (; currentPlayer < players.size(); currentPlayer++) {
+			Player& player = players[currentPlayer];
+
+			uint64_t used = GetInstructionCount() - start;
+			uint32_t budget = used < instructionBudget ? instructionBudget - (uint32_t)used : 0;
+
+			Cell from = player.GetPosition();
+			Yield yield = player.Move(boxes, occupancy, opponent, board, filledHoles, budget);
+
+			if (yield == Yield::Pending || yield == Yield::Loop) {
+				Logic();
+				return yield;
+			}
+
+			if (yield == Yield::Move) {
+				Cell to = player.GetPosition();
+				if (to != from) occupancy.MoveAgent(from.x, from.y, to.x, to.y);
+
+				PushBoxes(to, MoveTrace::GetMoveDirection(player.GetTrace().Back()));
+				isTickMoved = true;
+			}
+		}
+
+		Yield yield = isTickMoved ? Yield::Move : Yield::Done;
+		if (isTickMoved) EndTick();
+
+		currentPlayer = 0;
+		isTickMoved = false;
+		Logic();
+
+		return yield;
+	}
+
+	//Plays one move of the first player in an absolute direction without a program or the tile effects,
+	//returns whether it is counted
+	bool Play(int moveDirection, int facing) {
+		bool isCounted = PlayMove(players[0], moveDirection, facing);
+		EndTick();
+
+		return isCounted;
+	}
+
+	//Runs the programs at full speed until they end or instructionBudget instructions were spent, returns whether they ended
+	//Loops of a single player that settle into a cycle skip their remaining whole periods, so the cost follows
+	//the distinct states visited
+	bool FastForward(uint64_t instructionBudget = UINT64_MAX) {
+		const uint64_t start = GetInstructionCount();
+		const bool isCycleSkipped = players.size() == 1;
+
+		players[0].SetIsLoopBreak(isCycleSkipped);
+		while (isRun) {
+			uint64_t used = GetInstructionCount() - start;
+			if (used >= instructionBudget) break;
+
+			Yield yield = Step((uint32_t)std::min<uint64_t>(instructionBudget - used, UINT32_MAX));
+			if (yield == Yield::Loop) SkipCycles();
+		}
+		players[0].SetIsLoopBreak(false);
+
+		return !isRun;
+	}
+
+	//Tile effects and the win check for every player's cell, the run goes on while any program does
+	void Logic() {
+		const bool isAllTilesActive = GetIsAllTilesActive();
+		bool isAnyRun = false;
+
+		for (auto& player : players) {
+			Cell from = player.GetPosition();
+			bool isPlayerRun = isRun;
+			player.Logic(board, isPlayerRun, isAllTilesActive);
+			isAnyRun = isAnyRun || isPlayerRun;
+
+			//A spike sends the player back to its start cell
+			Cell to = player.GetPosition();
+			if (to != from) occupancy.MoveAgent(from.x, from.y, to.x, to.y);
+		}
+
+		isRun = isAnyRun;
+		if (mode == Mode::Race && GetWinner() >= 0) isRun = false;
+	}
+
+	void Reset() {
+		PlaceBoxes(false);
+		for (auto& box : boxes) box.Reset();
+		for (auto& tile : tiles) tile.Reset();
+		PlaceBoxes(true);
+		nActiveTiles = 0;
+		isTilesSynced = false;
+
+		for (const auto& a : filledHoles) {
+			board.OpenHole(a.x, a.y);
+		}
+		filledHoles.clear();
+
+		PlacePlayers(false);
+		for (auto& player : players) player.Reset();
+		PlacePlayers(true);
+
+		if (isOpponentInLevel) opponent.Reset();
+		currentPlayer = 0;
+		isTickMoved = false;
+		cycleDetector.Clear();
+	}
+
+	void GetState(WorldState& state) const {
+		state.playerCell = players[0].GetPosition();
+		state.direction = players[0].GetDirection();
+
+		state.otherPlayers.clear();
+		for (std::size_t i = 1; i < players.size(); i++) {
+			state.otherPlayers.emplace_back(players[i].GetPosition(), players[i].GetDirection());
+		}
+
+		state.boxes.clear();
+		for (const auto& box : boxes) {
+			state.boxes.emplace_back(box.GetPosition(), box.GetIsValue());
+		}
+
+		state.toggles.clear();
+		for (const auto& tile : tiles) {
+			state.toggles.push_back(tile.GetIsTileActive());
+		}
+
+		state.filledHoles = filledHoles;
+		state.opponentCell = opponent.GetPosition();
+		state.opponentIndex = opponent.GetIndex();
+		state.opponentDirection = opponent.GetDirection();
+	}
+
+	//Puts the entities and the terrain back to a state of the same level, the programs and the move traces are kept
+	//Players the state has no cell for keep theirs
+	void SetState(const WorldState& state) {
+		for (const auto& a : filledHoles) {
+			board.OpenHole(a.x, a.y);
+		}
+		for (const auto& a : state.filledHoles) {
+			board.FillHole(a.x, a.y);
+		}
+		filledHoles = state.filledHoles;
+
+		PlacePlayers(false);
+		players[0].SetState(state.playerCell, state.direction);
+		for (std::size_t i = 1; i < players.size() && i <= state.otherPlayers.size(); i++) {
+			players[i].SetState(state.otherPlayers[i - 1].first, state.otherPlayers[i - 1].second);
+		}
+		PlacePlayers(true);
+
+		PlaceBoxes(false);
+		for (std::size_t i = 0; i < boxes.size(); i++) {
+			boxes[i].SetPosition(state.boxes[i].first);
+			boxes[i].SetIsValue(state.boxes[i].second);
+		}
+		PlaceBoxes(true);
+
+		nActiveTiles = 0;
+		for (std::size_t i = 0; i < tiles.size(); i++) {
+			tiles[i].SetIsTileActive(state.toggles[i]);
+			nActiveTiles += state.toggles[i];
+		}
+		isTilesSynced = false;
+
+		opponent.SetState(state.opponentIndex, state.opponentDirection);
+	}
+
+	void GetRunState(RunState& state) const {
+		GetState(state.world);
+
+		state.players.resize(players.size());
+		for (std::size_t i = 0; i < players.size(); i++) {
+			players[i].GetRunState(state.players[i]);
+		}
+
+		state.currentPlayer = currentPlayer;
+		state.isRun = isRun;
+		state.isTickMoved = isTickMoved;
+	}
+
+	//Takes the current run back to a state from earlier in it
+	void SetRunState(const RunState& state) {
+		SetState(state.world);
+		for (std::size_t i = 0; i < players.size(); i++) {
+			players[i].SetRunState(state.players[i], board);
+		}
+
+		currentPlayer = state.currentPlayer;
+		isRun = state.isRun;
+		isTickMoved = state.isTickMoved;
+		cycleDetector.Clear();
+	}
+
+	RunResult GetResult() const {
+		RunResult result;
+		result.outcome = { GetIsWin(), GetIsAborted(), GetNMoves(), GetNSteps() };
+		result.playerCell = players[0].GetPosition();
+		result.direction = players[0].GetDirection();
+
+		for (const auto& box : boxes) {
+			result.boxes.emplace_back(box.GetPosition(), box.GetIsValue());
+		}
+
+		for (const auto& tile : tiles) {
+			result.toggles.push_back(tile.GetIsTileActive());
+		}
+
+		return result;
+	}
+
+	//Outcome of a program on a level without animation
+	static RunResult FastForward(const Level& level, const ItemMap& itemMap, const std::string& opponentPath, const std::vector<std::string>& strings,
+		Mode mode = Mode::Coop) {
+		World world;
+		world.SetMode(mode);
+		world.Load(level, itemMap, opponentPath);
+		world.Run(strings);
+		world.FastForward();
+
+		return world.GetResult();
+	}
+
+	void SetMode(Mode newMode) { mode = newMode; }
+
+	//Index of the player that won a race, -1 -> none yet
+	int GetWinner() const {
+		for (std::size_t i = 0; i < players.size(); i++) {
+			if (players[i].GetIsWin() && players[i].GetIsIndex()) return (int)i;
+		}
+		return -1;
+	}
+
+	bool GetIsWin() const {
+		if (mode == Mode::Race) return GetWinner() >= 0;
+
+		for (const auto& player : players) {
+			if (!player.GetIsWin()) return false;
+		}
+		return true;
+	}
+
+	bool GetIsAborted() const {
+		for (const auto& player : players) {
+			if (player.GetIsAborted()) return true;
+		}
+		return false;
+	}
+
+	//Counted moves of all players together
+	int64_t GetNMoves() const {
+		int64_t nMoves = 0;
+		for (const auto& player : players) nMoves += player.GetNMoves();
+		return nMoves;
+	}
+
+	int64_t GetNSteps() const {
+		int64_t nSteps = 0;
+		for (const auto& player : players) nSteps += (int64_t)player.GetTrace().GetSize();
+		return nSteps;
+	}
+
+	uint64_t GetInstructionCount() const {
+		uint64_t nInstructions = 0;
+		for (const auto& player : players) nInstructions += player.GetInstructionCount();
+		return nInstructions;
+	}
+
+	Board& GetBoard() { return board; }
+	const Board& GetBoard() const { return board; }
+	Player& GetPlayer() { return players[0]; }
+	const std::vector<Player>& GetPlayers() const { return players; }
+	Opponent& GetOpponent() { return opponent; }
+	const std::vector<Box>& GetBoxes() const { return boxes; }
+	const std::vector<ToggleTile>& GetTiles() const { return tiles; }
+	const Occupancy& GetOccupancy() const { return occupancy; }
+
+	inline Mode GetMode() const { return mode; }
+	inline uint64_t GetProgramHash() const { return programHash; }
+	inline bool GetIsRun() const { return isRun; }
+	inline bool GetIsToggleTileInLevel() const { return isToggleTileInLevel; }
+	inline bool GetIsOpponentInLevel() const { return isOpponentInLevel; }
+	inline bool GetIsAllTilesActive() const { return nActiveTiles == (int)tiles.size(); }
+};
@@ -0,0 +1,291 @@
+#pragma once
+#include "Simulation.h"
+#include <unordered_map>
+#include <random>
+#include <climits>
+
+//Result of searching a level for its fewest-move solution
+struct Solution {
+	bool isSolved, isExhausted; //isExhausted -> the state limit was hit before the search finished
+	int nMoves;					//Counted moves of the best solution
+	std::vector<int> moves;		//Absolute directions of the witness, blocked moves included
+	std::size_t nStates;		//Distinct states reached
+
+	//The witness as a program, turning before a move when it is neither forward nor back
+	std::vector<std::string> ToProgram() const {
+		std::vector<std::string> strings;
+		int facing = 0;
+
+		for (int move : moves) {
+			if (move == (facing + 2) % 4) {
+				strings.push_back("move bk");
+				continue;
+			}
+
+			if (move == (facing + 1) % 4) strings.push_back("turn rt");
+			else if (move == (facing + 3) % 4) strings.push_back("turn lt");
+
+			facing = move;
+			strings.push_back("move fd");
+		}
+
+		return strings;
+	}
+};
+
+//Packed world states deduplicated through Zobrist hashes, each state gets a dense index
+//Callers may append extra values (such as a facing) after the packed world state
+class StateTable {
+private:
+	std::size_t stride;			 //Packed values per state
+	std::vector<int16_t> states; //Packed state of every index
+	std::unordered_map<uint64_t, uint32_t> table;
+
+	std::vector<uint64_t> zobrist; //One random key per (slot, value)
+	int zobristRange;
+	std::size_t nBoxes, nToggles;
+	bool isOpponentInLevel;
+
+	uint64_t Hash(const std::vector<int16_t>& packed) const {
+		uint64_t hash = 0;
+		for (std::size_t i = 0; i < packed.size(); i++) {
+			int value = std::min(std::max((int)packed[i] + 1, 0), zobristRange - 1);
+			hash ^= zobrist[i * zobristRange + value];
+		}
+		return hash;
+	}
+public:
+	StateTable() {
+		stride = 0;
+		zobristRange = 0;
+		nBoxes = nToggles = 0;
+		isOpponentInLevel = false;
+	}
+
+	//Sizes the table for a loaded world, nExtra values follow each packed world state
+	void Reset(World& world, std::size_t nExtra = 0) {
+		states.clear();
+		table.clear();
+
+		nBoxes = world.GetBoxes().size();
+		nToggles = world.GetTiles().size();
+		isOpponentInLevel = world.GetIsOpponentInLevel();
+		stride = 2 + nBoxes * 5 + nToggles + (isOpponentInLevel ? 4 : 0) + nExtra;
+
+		const Board& board = world.GetBoard();
+		zobristRange = (int)std::max<uint32_t>(std::max(board.GetWidth(), board.GetHeight()), 8) + 2;
+		std::mt19937_64 random(0x5EED);
+		zobrist.resize(stride * zobristRange);
+		for (auto& key : zobrist) key = random();
+	}
+
+	void Pack(const WorldState& state, std::vector<int16_t>& packed) const {
+		packed.clear();
+		packed.push_back((int16_t)state.playerCell.x);
+		packed.push_back((int16_t)state.playerCell.y);
+
+		for (const auto& [cell, isValue] : state.boxes) {
+			packed.push_back((int16_t)cell.x);
+			packed.push_back((int16_t)cell.y);
+			packed.push_back(isValue);
+		}
+
+		for (bool isActive : state.toggles) packed.push_back(isActive);
+
+		std::size_t holeStart = packed.size();
+		for (std::size_t i = 0; i < state.boxes.size(); i++) {
+			packed.push_back((int16_t)(i < state.filledHoles.size() ? state.filledHoles[i].x : -1));
+			packed.push_back((int16_t)(i < state.filledHoles.size() ? state.filledHoles[i].y : -1));
+		}
+
+		//The order holes were filled in does not matter to the rules, insertion sort as there are only a few
+		std::size_t holeEnd = holeStart + 2 * state.filledHoles.size();
+		for (std::size_t i = holeStart + 2; i < holeEnd; i += 2) {
+			for (std::size_t j = i; j > holeStart && std::make_pair(packed[j - 2], packed[j - 1]) > std::make_pair(packed[j], packed[j + 1]); j -= 2) {
+				std::swap(packed[j - 2], packed[j]);
+				std::swap(packed[j - 1], packed[j + 1]);
+			}
+		}
+
+		if (isOpponentInLevel) {
+			packed.push_back((int16_t)state.opponentCell.x);
+			packed.push_back((int16_t)state.opponentCell.y);
+			packed.push_back((int16_t)state.opponentIndex);
+			packed.push_back((int16_t)state.opponentDirection);
+		}
+	}
+
+	//Unpacks into a state taken from the same world, so its vectors are already sized
+	void Unpack(uint32_t index, WorldState& state) const {
+		const int16_t* packed = Get(index);
+
+		state.playerCell = { packed[0], packed[1] };
+		state.direction = 0;
+		packed += 2;
+
+		for (auto& box : state.boxes) {
+			box = { { packed[0], packed[1] }, packed[2] != 0 };
+			packed += 3;
+		}
+
+		for (std::size_t i = 0; i < state.toggles.size(); i++) state.toggles[i] = *packed++ != 0;
+
+		state.filledHoles.clear();
+		for (std::size_t i = 0; i < state.boxes.size(); i++) {
+			if (packed[0] >= 0) state.filledHoles.push_back({ packed[0], packed[1] });
+			packed += 2;
+		}
+
+		if (isOpponentInLevel) {
+			state.opponentCell = { packed[0], packed[1] };
+			state.opponentIndex = packed[2];
+			state.opponentDirection = packed[3];
+		}
+	}
+
+	//Finds the index of a packed state or adds it, returns the index & whether it is new
+	std::pair<uint32_t, bool> Insert(const std::vector<int16_t>& packed) {
+		uint64_t key = Hash(packed);
+
+		while (true) {
+			auto it = table.find(key);
+			if (it == table.end()) break;
+
+			if (std::equal(packed.begin(), packed.end(), states.begin() + it->second * stride)) return { it->second, false };
+			key++; //Two states sharing a hash, probe the next key
+		}
+
+		uint32_t index = (uint32_t)(states.size() / stride);
+		table.emplace(key, index);
+		states.insert(states.end(), packed.begin(), packed.end());
+
+		return { index, true };
+	}
+
+	inline const int16_t* Get(uint32_t index) const { return &states[index * stride]; }
+	inline std::size_t GetSize() const { return stride > 0 ? states.size() / stride : 0; }
+};
+
+//Fewest-move search over the whole state of a level: player cell, boxes, filled holes, toggles & opponent phase
+//Moves are played by World itself so the rules can never drift from the game, turning is free so facing is left out
+//Blocked moves cost nothing but still advance the opponent, so the search is A* over 0-1 edge costs with
+//the distance to the nearest win tile as the heuristic
+class Solver {
+private:
+	struct Node {
+		uint32_t parent;
+		int8_t move;
+		int cost;
+	};
+
+	World world;
+	std::vector<Cell> winCells;
+	StateTable table;
+	std::vector<Node> nodes;
+
+	int Heuristic(uint32_t index) const {
+		const int16_t* packed = table.Get(index);
+
+		int best = INT_MAX;
+		for (const auto& cell : winCells) {
+			best = std::min(best, std::abs(cell.x - packed[0]) + std::abs(cell.y - packed[1]));
+		}
+		return best;
+	}
+
+	//Adds a state to the table and a node for it when new
+	std::pair<uint32_t, bool> Insert(const std::vector<int16_t>& packed) {
+		auto inserted = table.Insert(packed);
+		if (inserted.second) nodes.push_back({ UINT32_MAX, -1, INT_MAX });
+		return inserted;
+	}
+public:
+	Solution Solve(const Level& level, const ItemMap& itemMap, const std::string& opponentPath, std::size_t maxStates = 1 << 22) {
+		Solution solution = { false, false, 0, {}, 0 };
+
+		world.Load(level, itemMap, opponentPath);
+		table.Reset(world);
+		nodes.clear();
+
+		winCells.clear();
+		for (uint32_t i = 0; i < itemMap.GetHeight(); i++) {
+			for (uint32_t j = 0; j < itemMap.GetWidth(); j++) {
+				if (itemMap.GetCharacter(j, i) == 'W') winCells.push_back({ (int)j, (int)i });
+			}
+		}
+		if (winCells.empty()) return solution;
+
+		WorldState state, next;
+		std::vector<int16_t> packed;
+		world.GetState(state);
+		table.Pack(state, packed);
+
+		//Buckets of nodes by cost + heuristic, a node may sit in several buckets and only its cheapest entry counts
+		std::vector<std::vector<uint32_t>> buckets;
+		auto Push = [&](uint32_t index, int cost) {
+			std::size_t f = (std::size_t)(cost + Heuristic(index));
+			if (f >= buckets.size()) buckets.resize(f + 1);
+			buckets[f].push_back(index);
+		};
+
+		uint32_t root = Insert(packed).first;
+		nodes[root].cost = 0;
+		Push(root, 0);
+
+		const int startDirection = world.GetPlayer().GetDirection();
+
+		for (std::size_t f = 0; f < buckets.size(); f++) {
+			//Zero-cost edges add to the bucket being read, so it is read by index
+			for (std::size_t k = 0; k < buckets[f].size(); k++) {
+				uint32_t index = buckets[f][k];
+				Node node = nodes[index];
+				if (node.cost + Heuristic(index) != (int)f) continue; //Stale entry
+
+				table.Unpack(index, state);
+				world.SetState(state);
+				world.Logic();
+
+				if (world.GetPlayer().GetIsWin()) {
+					solution.isSolved = true;
+					solution.nMoves = node.cost;
+					for (uint32_t i = index; nodes[i].parent != UINT32_MAX; i = nodes[i].parent) {
+						solution.moves.push_back(nodes[i].move);
+					}
+					std::reverse(solution.moves.begin(), solution.moves.end());
+					solution.nStates = nodes.size();
+					return solution;
+				}
+
+				for (int move = 0; move < 4; move++) {
+					world.SetState(state);
+					int cost = node.cost + (world.Play(move, startDirection) ? 1 : 0);
+
+					//A spike ends the run without a win
+					Cell cell = world.GetPlayer().GetPosition();
+					if (world.GetBoard().GetItem(cell.x, cell.y) == 'S') continue;
+
+					world.GetState(next);
+					table.Pack(next, packed);
+
+					auto [child, isNew] = Insert(packed);
+					if (cost < nodes[child].cost) {
+						nodes[child] = { index, (int8_t)move, cost };
+						Push(child, cost);
+					}
+
+					if (isNew && nodes.size() >= maxStates) {
+						solution.isExhausted = true;
+						solution.nStates = nodes.size();
+						return solution;
+					}
+				}
+			}
+
+			buckets[f].clear();
+			buckets[f].shrink_to_fit();
+		}
+
+		solution.nStates = nodes.size();
+		return solution;
+	}
+};
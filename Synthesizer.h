@@ -0,0 +1,272 @@
+#pragma once
+#include "Solver.h"
+#include "ThreadPool.h"
+
+//Shortest program found for a level
+struct Golf {
+	bool isSolved, isExhausted; //isExhausted -> the state limit was hit, so a shorter program may exist
+	std::vector<std::string> program;
+	std::size_t nStates, nStatements; //Distinct (state, facing) pairs reached & candidate statements per state
+};
+
+//Searches for the program with the fewest console lines that wins a level
+//At the top level a program is a sequence of statements, and each one's effect depends only on the world state and the
+//facing it starts from, so the search is a shortest path over (state, facing) with every candidate statement as an edge
+//costing its lines: programs reaching the same state are equivalent and only the shortest is kept, statements that hit a
+//spike, abort or change nothing are dropped, and nothing is expanded that cannot beat the best program found so far
+//Every state's statements are played on the headless World in parallel
+class Synthesizer {
+private:
+	typedef std::vector<std::string> Lines;
+
+	struct Candidate {
+		Lines lines;
+		int nLines, nFinalLines; //nFinalLines -> lines when the statement ends the program and its closing keywords can go
+		std::shared_ptr<const Program> program;
+	};
+
+	struct Node {
+		uint32_t parent;
+		int32_t statement;
+		int cost;
+	};
+
+	struct Result {
+		std::vector<int16_t> packed;
+		bool isValid, isWin;
+	};
+
+	std::vector<Candidate> candidates;
+	std::vector<int> counts; //Loop counts tried
+
+	static bool IsTurn(const std::string& line) { return line.compare(0, 4, "turn") == 0; }
+
+	//Turns that cancel out or three equal turns are never shorter than what they can be replaced with
+	static bool IsWastefulTurn(const Lines& lines, const std::string& next) {
+		if (!IsTurn(next) || lines.empty() || !IsTurn(lines.back())) return false;
+		if (lines.back() != next) return true;
+
+		return lines.size() >= 2 && lines[lines.size() - 2] == next;
+	}
+
+	//Statements of at most maxLines lines, the last statement of a loop body may leave its endif to the loop's end
+	void GenerateStatements(int maxLines, bool isLastInLoop, std::vector<Lines>& out) const {
+		if (maxLines < 1) return;
+
+		for (const char* line : { "move fd", "move bk", "turn rt", "turn lt" }) out.push_back({ line });
+
+		//repeat n / body / end
+		std::vector<Lines> bodies;
+		GenerateBodies(maxLines - 2, true, bodies);
+		for (const auto& body : bodies) {
+			bool isTurnsOnly = std::all_of(body.begin(), body.end(), IsTurn);
+			if (isTurnsOnly) continue;
+
+			for (int count : counts) {
+				Lines lines = { "repeat " + std::to_string(count) };
+				lines.insert(lines.end(), body.begin(), body.end());
+				lines.push_back("end");
+				out.push_back(std::move(lines));
+			}
+		}
+
+		//if fd empty / then / [else / otherwise] / endif
+		const int nEndIf = isLastInLoop ? 0 : 1;
+		std::vector<Lines> thenBodies;
+		GenerateBodies(maxLines - 1 - nEndIf, false, thenBodies);
+		for (const auto& then : thenBodies) {
+			Lines lines = { "if fd empty" };
+			lines.insert(lines.end(), then.begin(), then.end());
+			if (nEndIf) lines.push_back("endif");
+			out.push_back(lines);
+
+			std::vector<Lines> elseBodies;
+			GenerateBodies(maxLines - 2 - nEndIf - (int)then.size(), false, elseBodies);
+			for (const auto& otherwise : elseBodies) {
+				if (otherwise == then) continue;
+
+				Lines withElse = { "if fd empty" };
+				withElse.insert(withElse.end(), then.begin(), then.end());
+				withElse.push_back("else");
+				withElse.insert(withElse.end(), otherwise.begin(), otherwise.end());
+				if (nEndIf) withElse.push_back("endif");
+				out.push_back(std::move(withElse));
+			}
+		}
+	}
+
+	//Non-empty statement sequences of at most maxLines lines
+	void GenerateBodies(int maxLines, bool isLoopBody, std::vector<Lines>& out) const {
+		if (maxLines < 1) return;
+
+		std::vector<Lines> lasts;
+		GenerateStatements(maxLines, isLoopBody, lasts);
+		out.insert(out.end(), lasts.begin(), lasts.end());
+
+		std::vector<Lines> heads;
+		GenerateStatements(maxLines - 1, false, heads);
+		for (const auto& head : heads) {
+			std::vector<Lines> tails;
+			GenerateBodies(maxLines - (int)head.size(), isLoopBody, tails);
+
+			for (const auto& tail : tails) {
+				if (IsWastefulTurn(head, tail.front())) continue;
+
+				Lines lines = head;
+				lines.insert(lines.end(), tail.begin(), tail.end());
+				out.push_back(std::move(lines));
+			}
+		}
+	}
+
+	static int CountFinalLines(const Lines& lines) {
+		int n = (int)lines.size();
+		while (n > 1 && (lines[n - 1] == "end" || lines[n - 1] == "endif")) n--;
+		return n;
+	}
+
+	//Plays one statement from a state & facing, the facing it ends with is packed after the state
+	static void Evaluate(World& world, const StateTable& table, const WorldState& state, int facing,
+		const Candidate& candidate, WorldState& next, Result& result) {
+		world.SetState(state);
+		world.Run(candidate.program, facing);
+		world.FastForward();
+
+		const Player& player = world.GetPlayer();
+		result.isValid = !player.GetIsAborted() && !player.GetIsSpiked();
+		if (!result.isValid) return;
+
+		world.GetState(next);
+		table.Pack(next, result.packed);
+		result.packed.push_back((int16_t)player.GetInterpreter().GetDirection());
+		result.isWin = player.GetIsWin();
+	}
+public:
+	//Loop counts 2 to maxRepeat, statements other than single moves & turns take at most maxStatementLines lines
+	Synthesizer(int maxStatementLines = 5, int maxRepeat = 9) {
+		for (int n = 2; n <= maxRepeat; n++) counts.push_back(n);
+
+		std::vector<Lines> statements;
+		GenerateStatements(maxStatementLines, false, statements);
+
+		for (auto& lines : statements) {
+			Candidate candidate;
+			candidate.nLines = (int)lines.size();
+			candidate.nFinalLines = CountFinalLines(lines);
+			candidate.program = std::make_shared<const Program>(Program::Compile(lines));
+			candidate.lines = std::move(lines);
+			candidates.push_back(std::move(candidate));
+		}
+	}
+
+	//bound is any winning program (such as a solver witness), only shorter programs are searched for
+	Golf Synthesize(const Level& level, const ItemMap& itemMap, const std::string& opponentPath,
+		const Lines& bound, ThreadPool& pool, std::size_t maxStates = 1 << 13) {
+		Golf golf = { !bound.empty(), false, bound, 0, candidates.size() };
+		int best = bound.empty() ? INT_MAX : (int)bound.size();
+
+		//One world per worker
+		std::vector<World> worlds(pool.GetSize());
+		for (auto& world : worlds) world.Load(level, itemMap, opponentPath);
+
+		StateTable table;
+		table.Reset(worlds[0], 1);
+
+		WorldState state;
+		std::vector<int16_t> packed;
+		worlds[0].GetState(state);
+		table.Pack(state, packed);
+		packed.push_back(0); //Programs start facing right
+		const std::size_t facingSlot = packed.size() - 1;
+
+		worlds[0].Logic();
+		if (worlds[0].GetPlayer().GetIsWin()) {
+			golf.isSolved = true;
+			golf.program.clear();
+			return golf;
+		}
+
+		std::vector<Node> nodes;
+		std::vector<std::vector<uint32_t>> buckets(1);
+		table.Insert(packed);
+		nodes.push_back({ UINT32_MAX, -1, 0 });
+		buckets[0].push_back(0);
+
+		uint32_t bestParent = UINT32_MAX;
+		int32_t bestStatement = -1;
+
+		std::vector<Result> results(candidates.size());
+		std::vector<WorldState> nexts(pool.GetSize(), state);
+
+		for (std::size_t cost = 0; cost < buckets.size() && (int)cost + 1 < best; cost++) {
+			for (std::size_t k = 0; k < buckets[cost].size() && (int)cost + 1 < best; k++) {
+				uint32_t index = buckets[cost][k];
+				if (nodes[index].cost != (int)cost) continue; //Stale entry
+
+				table.Unpack(index, state);
+				const int facing = table.Get(index)[facingSlot];
+
+				//Workers take contiguous slices of the candidates
+				const std::size_t nSlices = pool.GetSize();
+				const int limit = best;
+				pool.ForEach(nSlices, [&](std::size_t slice) {
+					std::size_t begin = candidates.size() * slice / nSlices, end = candidates.size() * (slice + 1) / nSlices;
+					for (std::size_t i = begin; i < end; i++) {
+						results[i].isValid = false;
+						if ((int)cost + candidates[i].nFinalLines >= limit) continue;
+
+						Evaluate(worlds[slice], table, state, facing, candidates[i], nexts[slice], results[i]);
+					}
+				});
+
+				for (std::size_t i = 0; i < candidates.size(); i++) {
+					const Result& result = results[i];
+					if (!result.isValid) continue;
+
+					if (result.isWin && (int)cost + candidates[i].nFinalLines < best) {
+						best = (int)cost + candidates[i].nFinalLines;
+						bestParent = index;
+						bestStatement = (int32_t)i;
+					}
+
+					//A state entered with n lines needs at least one more to win
+					int childCost = (int)cost + candidates[i].nLines;
+					if (childCost + 1 >= best) continue;
+
+					auto [child, isNew] = table.Insert(result.packed);
+					if (isNew) nodes.push_back({ UINT32_MAX, -1, INT_MAX });
+					if (childCost < nodes[child].cost) {
+						nodes[child] = { index, (int32_t)i, childCost };
+						if ((std::size_t)childCost >= buckets.size()) buckets.resize(childCost + 1);
+						buckets[childCost].push_back(child);
+					}
+				}
+
+				if (nodes.size() >= maxStates) break;
+			}
+
+			if (nodes.size() >= maxStates) break;
+		}
+
+		golf.nStates = nodes.size();
+		golf.isExhausted = nodes.size() >= maxStates;
+		if (bestStatement < 0) return golf;
+
+		//Statements from the last back to the first, only the last may drop its closing keywords
+		std::vector<int32_t> path = { bestStatement };
+		for (uint32_t i = bestParent; nodes[i].parent != UINT32_MAX; i = nodes[i].parent) path.push_back(nodes[i].statement);
+		std::reverse(path.begin(), path.end());
+
+		golf.isSolved = true;
+		golf.program.clear();
+		for (std::size_t i = 0; i < path.size(); i++) {
+			const Candidate& candidate = candidates[path[i]];
+			int n = i + 1 < path.size() ? candidate.nLines : candidate.nFinalLines;
+			golf.program.insert(golf.program.end(), candidate.lines.begin(), candidate.lines.begin() + n);
+		}
+
+		return golf;
+	}
+
+	inline std::size_t GetStatementCount() const { return candidates.size(); }
+};
@@ -0,0 +1,88 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+//Fixed set of worker threads that share out the indices of a job
+//Workers take one index at a time, so long and short tasks even out across the threads
+class ThreadPool {
+private:
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable wake, done;
+
+	std::function<void(std::size_t)> job;
+	std::atomic<std::size_t> next;
+	std::size_t nTasks, nBusy;
+	uint64_t generation; //Bumped for every job so sleeping workers know there is new work
+	bool isStopping;
+
+	void Work() {
+		uint64_t seen = 0;
+
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [&] { return isStopping || generation != seen; });
+				if (isStopping) return;
+				seen = generation;
+			}
+
+			for (std::size_t i = next++; i < nTasks; i = next++) {
+				job(i);
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+			if (--nBusy == 0) done.notify_all();
+		}
+	}
+public:
+	explicit ThreadPool(std::size_t nThreads = std::thread::hardware_concurrency()) {
+		nTasks = 0;
+		nBusy = 0;
+		generation = 0;
+		isStopping = false;
+		next = 0;
+
+		if (nThreads == 0) nThreads = 1;
+		for (std::size_t i = 0; i < nThreads; i++) {
+			threads.emplace_back(&ThreadPool::Work, this);
+		}
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			isStopping = true;
+		}
+		wake.notify_all();
+
+		for (auto& thread : threads) thread.join();
+	}
+
+	//Calls task(i) for every i below n across the workers and returns when all have finished
+	void ForEach(std::size_t n, std::function<void(std::size_t)> task) {
+		if (n == 0) return;
+
+		std::unique_lock<std::mutex> lock(mutex);
+		job = std::move(task);
+		nTasks = n;
+		next = 0;
+		nBusy = threads.size();
+		generation++;
+		wake.notify_all();
+
+		done.wait(lock, [&] { return nBusy == 0; });
+		job = nullptr;
+	}
+
+	inline std::size_t GetSize() const { return threads.size(); }
+};
@@ -0,0 +1,75 @@
+#pragma once
+#include <SFML/Graphics/VertexArray.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include "ChunkedGrid.h"
+
+//Tiles of a grid drawn as quads of one vertex array against a tileset, so the whole layer is a single draw call
+//A cell gets its quad the first time it is given a tile & only that quad is rewritten when its tile changes
+class TileLayer {
+private:
+	sf::VertexArray quads;
+	ChunkedGrid<int32_t> quadOfCell; //First vertex of each cell's quad, -1 -> the cell never had a tile
+	const sf::Texture* texture;
+	float tileSize;
+	uint32_t width, height;
+public:
+	TileLayer()
+		: quads(sf::Quads) {
+		texture = nullptr;
+		tileSize = 0.0f;
+		width = height = 0;
+	}
+
+	//Empties the layer, its cells are tileSize pixels & the tileset is cut into cells of the same size
+	void Reset(const sf::Texture& tileset, uint32_t newWidth, uint32_t newHeight, float newTileSize) {
+		texture = &tileset;
+		tileSize = newTileSize;
+		width = newWidth;
+		height = newHeight;
+
+		quads.clear();
+		quadOfCell.Reset(width, height, -1);
+	}
+
+	//Shows the tileset cell (tileX, tileY) in the cell (x, y)
+	void SetTile(uint32_t x, uint32_t y, int tileX, int tileY) {
+		if (x >= width || y >= height) return;
+
+		int32_t& first = quadOfCell.At(x, y);
+		if (first < 0) {
+			first = (int32_t)quads.getVertexCount();
+			quads.resize(quads.getVertexCount() + 4);
+
+			float left = x * tileSize, top = y * tileSize;
+			quads[first + 0].position = { left, top };
+			quads[first + 1].position = { left + tileSize, top };
+			quads[first + 2].position = { left + tileSize, top + tileSize };
+			quads[first + 3].position = { left, top + tileSize };
+		}
+
+		float u = tileX * tileSize, v = tileY * tileSize;
+		quads[first + 0].texCoords = { u, v };
+		quads[first + 1].texCoords = { u + tileSize, v };
+		quads[first + 2].texCoords = { u + tileSize, v + tileSize };
+		quads[first + 3].texCoords = { u, v + tileSize };
+
+		for (int i = 0; i < 4; i++) quads[first + i].color = sf::Color::White;
+	}
+
+	//The cell keeps its quad, hidden, so showing a tile in it again does not grow the array
+	void ClearTile(uint32_t x, uint32_t y) {
+		if (x >= width || y >= height || !quadOfCell.GetIsPainted(x, y)) return;
+
+		int32_t first = quadOfCell.Get(x, y);
+		if (first < 0) return;
+
+		for (int i = 0; i < 4; i++) quads[first + i].color = sf::Color::Transparent;
+	}
+
+	void Render(sf::RenderTarget& target) const {
+		if (quads.getVertexCount() > 0) target.draw(quads, sf::RenderStates(texture));
+	}
+
+	inline std::size_t GetQuadCount() const { return quads.getVertexCount() / 4; }
+};
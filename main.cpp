@@ -3,23 +3,85 @@
 #include "GraphicsRender.h"
 #include "AssetManager.h"
 #include "GraphicsUI.h"
-#include <iterator>
+#include "Simulation.h"
+#include "LevelManager.h"
+#include "Replay.h"
+#include "Debugger.h"
+#include "TileLayer.h"
+#include "Compositor.h"
+#include <algorithm>
 #include <ctime>
 #include <list>
-#include <Windows.h>
+#include <filesystem>
 
 const float pixelSize = 32.0f;
 
-std::vector<std::string> ToWords(const std::string& string) {
-	//String to words
-	std::istringstream iss(string);
-	std::vector<std::string> v;
-	std::copy(std::istream_iterator<std::string>(iss),
-		std::istream_iterator<std::string>(),
-		std::back_inserter(v));
-
-	return v;
-};
+inline sf::Vector2f ToPixels(const Cell& cell) {
+	return sf::Vector2f((float)cell.x, (float)cell.y) * pixelSize;
+}
+
+//Cell of the tileset drawn for a terrain character, false -> nothing is drawn
+bool GetTerrainTile(char c, sf::Vector2i& tile) {
+	switch (c) {
+	case '#':
+		tile = { 1, 1 };
+		break;
+	case '1':
+		tile = { 0, 0 };
+		break;
+	case '2':
+		tile = { 1, 0 };
+		break;
+	case '3':
+		tile = { 2, 0 };
+		break;
+	case '4':
+		tile = { 2, 1 };
+		break;
+	case '5':
+		tile = { 2, 2 };
+		break;
+	case '6':
+		tile = { 1, 2 };
+		break;
+	case '7':
+		tile = { 0, 2 };
+		break;
+	case '8':
+		tile = { 0, 1 };
+		break;
+	case '9':
+		tile = { 3, 0 };
+		break;
+	default:
+		return false;
+	}
+	return true;
+}
+
+//Cell of the tileset drawn for an item character, isWinOpen -> every toggle tile is pressed
+bool GetItemTile(char c, bool isWinOpen, sf::Vector2i& tile) {
+	switch (c) {
+	case 'A':
+		tile = { 5, 0 };
+		break;
+	case 'S':
+		tile = { 5, 1 };
+		break;
+	case 'W':
+		tile = { 4, isWinOpen ? 0 : 1 };
+		break;
+	case 'B':
+		tile = { 3, 1 };
+		break;
+	case 'T':
+		tile = { 4, 2 };
+		break;
+	default:
+		return false;
+	}
+	return true;
+}
 
 class TextWindow {
 private:
@@ -31,6 +93,39 @@ private:
 	int textIndex, showTextIndex;	  //textIndex -> index of active string, showTextIndex for rendering
 	uint32_t nShowText;				  //nShowText for rendering
 	sf::Text text;					  //Text for rendering to the window
+	bool isEdited;					  //Lines changed since they were last coloured
+
+	//What a line draws, built again only when the line or whether it is the active one changes
+	struct LineText {
+		std::string source;			//Line the rest was built from
+		bool isActive;
+		sf::String prompt;			//"> " & the line, with a cursor on the active line
+		sf::String argument;		//Second word of a highlighted command, empty when there is none
+		Keyword command;
+		std::size_t commandLength;
+	};
+	std::vector<LineText> lineTexts;
+
+	const LineText& GetLineText(int i) {
+		if ((int)lineTexts.size() <= i) lineTexts.resize(i + 1, { "", false, sf::String(), sf::String(), Keyword::None, 0 });
+
+		LineText& line = lineTexts[i];
+		const bool isActive = i == textIndex;
+		//An entry never built has no prompt
+		if (line.source == strings[i] && line.isActive == isActive && !line.prompt.isEmpty()) return line;
+
+		line.source = strings[i];
+		line.isActive = isActive;
+		line.prompt = "> " + line.source + (isActive ? "_" : "");
+
+		Token tokens[maxTokens];
+		std::size_t nTokens = Tokenize(line.source, tokens);
+		line.command = nTokens > 1 ? tokens[0].keyword : Keyword::None;
+		line.commandLength = nTokens > 1 ? tokens[0].text.size() : 0;
+		line.argument = nTokens > 1 ? std::string(tokens[1].text) : std::string();
+
+		return line;
+	}
 
 	void Input(int character) {
 
@@ -107,6 +202,51 @@ private:
 		}
 	}
 
+	//Keeps single argument commands on the active line from growing past their argument
+	void TrimActiveString(int line) {
+		if (line != textIndex) return;
+
+		std::string activeString = textString.str();
+
+		while (activeString.size() > (uint32_t)(line == 0 ? 7 : 8)) {
+			activeString.pop_back();
+		}
+
+		textString.str("");
+		textString << std::move(activeString);
+	}
+
+	void SetColor(int line, const sf::Color& color) {
+		if (line >= 0 && line < (int)colors.size()) colors[line] = color;
+	}
+
+	void ColorBlock(const Block& block, int loopDepth) {
+		for (const auto& statement : block) {
+			switch (statement.type) {
+			case Statement::Type::Move:
+				SetColor(statement.line, loopDepth > 0 ? sf::Color(0, 200, 100) : sf::Color::Cyan);
+				if (loopDepth == 0) TrimActiveString(statement.line);
+				break;
+			case Statement::Type::Turn:
+				SetColor(statement.line, loopDepth > 0 ? sf::Color(200, 100, 0) : sf::Color::Yellow);
+				if (loopDepth == 0) TrimActiveString(statement.line);
+				break;
+			case Statement::Type::Repeat:
+				SetColor(statement.line, sf::Color(255, 100, 0));
+				SetColor(statement.endLine, sf::Color(255, 100, 0));
+				ColorBlock(statement.body, loopDepth + 1);
+				break;
+			case Statement::Type::If:
+				SetColor(statement.line, sf::Color(100, 255, 255));
+				SetColor(statement.elseLine, sf::Color(100, 255, 255));
+				SetColor(statement.endLine, sf::Color(100, 255, 255));
+				ColorBlock(statement.body, loopDepth);
+				ColorBlock(statement.elseBody, loopDepth);
+				break;
+			}
+		}
+	}
+
 	void Push(const std::string& str) {
 		colors.push_back(sf::Color::White);
 		strings.push_back(str);
@@ -124,6 +264,7 @@ public:
 
 		textIndex = 0;
 		showTextIndex = 0;
+		isEdited = true;
 
 		const sf::Vector2u windowSize = { 512, 512 };
 		nShowText = (uint32_t)(windowSize.y / text.getCharacterSize() - 3);
@@ -142,6 +283,7 @@ public:
 
 		textIndex = 0;
 		showTextIndex = 0;
+		isEdited = true;
 	}
 
 	void ManageEvent(sf::Event e) {
@@ -149,6 +291,7 @@ public:
 		case sf::Event::TextEntered:
 			if (e.text.unicode < 128) {
 				Input(e.text.unicode);
+				isEdited = true;
 			}
 			break;
 		case sf::Event::Resized:
@@ -166,99 +309,35 @@ public:
 				AddNewLine();
 				break;
 			}
+			isEdited = true;
 			break;
 		}
 
-		strings[textIndex] = textString.str();
+		if (isEdited) strings[textIndex] = textString.str();
 	}
 
 	void Logic() {
+		if (!isEdited) return;
+		isEdited = false;
 
-		int value = 0;
-		for (int i = 0; i < (int)strings.size(); i++) {
-
-			//Value variable is to make sure that loop instructions are not re-read
-			int stringIndex = i + value;
-			if (stringIndex > (int)(strings.size() - 1)) stringIndex = ((int)strings.size() - 1);
-
-			auto stringText = ToWords(strings[stringIndex]);
-			if (stringText.size() == 0) continue;
-
-			colors[stringIndex] = sf::Color::White;
-
-			if (stringText.size() > 1) {
-				if (stringText[0] == "turn") {
-					colors[stringIndex] = sf::Color::Yellow;
-					if (i == textIndex) {
-						std::string activeString = textString.str();
-
-						while (activeString.size() > (uint32_t)(i == 0 ? 7 : 8)) {
-							activeString.pop_back();
-						}
-
-						textString.str("");
-						textString << std::move(activeString);
-					}
-				}
-				else if (stringText[0] == "move") {
-					colors[stringIndex] = sf::Color::Cyan;
-					if (i == textIndex) {
-						std::string activeString = textString.str();
-
-						while (activeString.size() > (uint32_t)(i == 0 ? 7 : 8)) {
-							activeString.pop_back();
-						}
-
-						textString.str("");
-						textString << std::move(activeString);
-					}
-				}
-				if (stringText[0] == "loop" || stringText[0] == "repeat") {
-					for (int j = stringIndex; j < (int)strings.size(); j++) {
-
-						auto loopText = ToWords(strings[j]);
-						if (loopText.size() == 0) continue;
-
-						
-						colors[j] = sf::Color(255, 255, 255);
-						if (loopText[0] == "loop" || loopText[0] == "repeat") {
-							colors[j] = sf::Color(255, 100, 0);
-						}
-
-						if (loopText[0] == "move") {
-							colors[j] = sf::Color(0, 200, 100);
-						}
-
-						if (loopText[0] == "turn") {
-							colors[j] = sf::Color(200, 100, 0);
-						}
+		for (auto& color : colors) color = sf::Color::White;
 
-						if (loopText[0] == "if") colors[j] = sf::Color(100, 255, 255);
-
-						if (loopText[0] == "else" || loopText[0] == "closeif" || loopText[0] == "endif") colors[j] = sf::Color(100, 255, 255);
+		ColorBlock(Parser::Parse(strings), 0);
+	}
 
-						if (loopText[0] == "closeloop" || loopText[0] == "end") { //loop close
-							colors[j] = sf::Color(255, 100, 0);
-							break;
-						}
-						value++;
-					}
-				}
-				if (stringText[0] == "if" || stringText[0] == "else" || stringText[0] == "endif" || stringText[0] == "closeif") {
-					colors[i] = sf::Color(100, 255, 255);
-				}
-			}
-		}
+	//The frame rarely changes & is drawn apart from the lines
+	void RenderBox(sf::RenderTarget& target) const {
+		target.draw(box);
 	}
 
 	void Render(sf::RenderWindow& window) {
-		window.draw(box);
-
 		float pos = 2.0f;
 
-		for (int i = showTextIndex; i < (int)strings.size(); i++) {
+		static const sf::String moveHint("> move fd"), loopHint("> loop n\n> [statements...]\n> end"), turnHint("> turn [dir]"),
+			ifHint("> if fd empty\n> [action1]\n> else\n> [action2]\n> endif");
 
-			auto stringText = ToWords(strings[i]);
+		for (int i = showTextIndex; i < (int)strings.size(); i++) {
+			const LineText& line = GetLineText(i);
 
 			text.setPosition(window.getSize().x - 152.0f, pos * (float)text.getCharacterSize());
 			text.setFillColor(sf::Color(255, 255, 255, 100));
@@ -269,39 +348,40 @@ public:
 
 			if ((int)strView.size() > index) {
 				if (strView[index] == 'm') {
-					text.setString(sf::String("> move fd"));
+					text.setString(moveHint);
 					window.draw(text);
 				}
 				if (strView[index] == 'l' && strView.size() < 5) {
-					text.setString(sf::String("> loop n\n> [statements...]\n> end"));
+					text.setString(loopHint);
 					window.draw(text);
 				}
 				if (strView[index] == 't' && strView.size() < 5) {
-					text.setString(sf::String("> turn [dir]"));
+					text.setString(turnHint);
 					window.draw(text);
 				}
 				if (strView[index] == 'i') {
 					if (strView.size() < 12) {
-						text.setString(sf::String("> if fd empty\n> [action1]\n> else\n> [action2]\n> endif"));
+						text.setString(ifHint);
 						window.draw(text);
 					}
 				}
 			}
 
 			text.setFillColor(colors[i]);
-			text.setString("> " + strings[i] + (i == textIndex ? "_" : ""));
+			text.setString(line.prompt);
 			window.draw(text);
 
-			if (stringText.size() > 1) {
-				if (stringText[0] == "move" || stringText[0] == "loop" || stringText[0] == "repeat" || stringText[0] == "turn") {
-					if (stringText[0] == "move") text.setFillColor(sf::Color::Green);
-					else if (stringText[0] == "loop" || stringText[0] == "repeat") text.setFillColor(sf::Color::Magenta);
-					else if (stringText[0] == "turn") text.setFillColor(sf::Color(200, 100, 0));
-					text.setString(stringText[1]);
+			if (!line.argument.isEmpty()) {
+				Keyword command = line.command;
+				if (command == Keyword::Move || command == Keyword::Loop || command == Keyword::Repeat || command == Keyword::Turn) {
+					if (command == Keyword::Move) text.setFillColor(sf::Color::Green);
+					else if (command == Keyword::Loop || command == Keyword::Repeat) text.setFillColor(sf::Color::Magenta);
+					else if (command == Keyword::Turn) text.setFillColor(sf::Color(200, 100, 0));
+					text.setString(line.argument);
 
-					float positionX = (float)window.getSize().x - stringText[0].size() * text.getCharacterSize();
-					if (stringText[0] == "move" || stringText[0] == "turn" || stringText[0] == "loop") { positionX -= 30.0f; }
-					else if (stringText[0] == "repeat") { positionX += 18.0f; }
+					float positionX = (float)window.getSize().x - line.commandLength * text.getCharacterSize();
+					if (command == Keyword::Move || command == Keyword::Turn || command == Keyword::Loop) { positionX -= 30.0f; }
+					else if (command == Keyword::Repeat) { positionX += 18.0f; }
 
 					text.setPosition(positionX, pos * (float)text.getCharacterSize());
 					window.draw(text);
@@ -321,7 +401,7 @@ public:
 	}
 
 	std::vector<sf::Color>& Colors() { return colors; }
-	inline std::vector<std::string> GetStrings() const { return strings; }
+	inline const std::vector<std::string>& GetStrings() const { return strings; }
 };
 
 typedef std::vector<std::vector<std::string>> Texts;
@@ -329,6 +409,7 @@ class TextManager {
 private:
 	Texts texts;
 	int index;
+	std::vector<CachedText> helpTexts; //One for each line of the help drawn
 public:
 	TextManager() {
 		index = 0;
@@ -373,12 +454,14 @@ public:
 
 	Texts GetTexts() const { return texts; }
 
-	void DrawTextHelp(const sf::Vector2f& pos, sf::RenderWindow& window) {
+	void DrawTextHelp(const sf::Vector2f& pos, sf::RenderTarget& window) {
 
 		float textPos = pos.y;
 
+		if (helpTexts.size() < texts[index].size()) helpTexts.resize(texts[index].size());
+
 		for (int i = 0; i < (int)texts[index].size(); i++) {
-			RenderText(window, AssetHolder::Get().GetFont("lucidaConsole"), pos.x, pos.y + i * 16.0f, texts[index][i], sf::Color::White, 16);
+			RenderText(helpTexts[i], window, AssetHolder::Get().GetFont("lucidaConsole"), pos.x, pos.y + i * 16.0f, texts[index][i], sf::Color::White, 16);
 		}
 	}
 };
@@ -528,16 +611,46 @@ public:
 class EditorState : public GameState {
 private:
 	sf::Vector2f mousePosition, playerPos;
-	sf::Sprite tileSet, tile;
+	sf::Sprite tileSet;
 	sf::RectangleShape tilePixel, selectedTile;
 	std::list<Tile> levelTiles;
+	TileLayer terrainLayer, itemLayer; //Quads of the placed tiles, a cell's quads are patched when it is edited
+	Compositor canvasLayers;		   //Grid & placed tiles, drawn again after an edit
 	const std::string& tileCharacters = "1239W8#4BT765.."; //Tile Characters
 	int index, tileSetWidth, tileSetOffset;
 
 	bool isTileSetDrawn, isKeyPressed;
 	int nLineWidth, nLineHeight; //Max lines along with and height
+	sf::Vector2f scroll; //Top left of the canvas in view, arrows scroll canvases larger than the window
+	sf::View canvasView;
+	CachedText playerText, helpText;
+
+	//Cell of the canvas under a point of the window
+	sf::Vector2i GetCell(const sf::Vector2f& pos) const {
+		return (sf::Vector2i)((pos + scroll) / pixelSize);
+	}
 
-	void DrawGrid(sf::RenderWindow& window, float x1, float y1, float x2, float y2) {
+	//Moves the view by (dx, dy) cells, the canvas stops at the tile set & the bottom of the window
+	void Scroll(int dx, int dy) {
+		float maxX = std::max(nLineHeight * pixelSize - tileSet.getPosition().x, 0.0f);
+		float maxY = std::max(nLineWidth * pixelSize - (float)windowSize.y, 0.0f);
+		scroll.x = std::clamp(scroll.x + dx * pixelSize, 0.0f, maxX);
+		scroll.y = std::clamp(scroll.y + dy * pixelSize, 0.0f, maxY);
+
+		canvasView.setCenter(scroll.x + windowSize.x / 2.0f, scroll.y + windowSize.y / 2.0f);
+		canvasLayers.Invalidate();
+	}
+
+	//Grows or shrinks the canvas by (dx, dy) cells, tiles left outside it are dropped when the level is run
+	void Resize(int dx, int dy) {
+		nLineHeight = std::max(nLineHeight + dx, 2);
+		nLineWidth = std::max(nLineWidth + dy, 2);
+
+		BuildLayers();
+		Scroll(0, 0);
+	}
+
+	void DrawGrid(sf::RenderTarget& window, float x1, float y1, float x2, float y2) {
 		for (int i = 0; i < nLineWidth; i++) {
 			DrawLine(window, x1, y1 + i * pixelSize, x2, y1 + i * pixelSize);
 		}
@@ -547,6 +660,38 @@ private:
 		}
 	}
 
+	//Shows the tiles placed in a cell, the later of two in the same layer on top
+	void PatchCell(int x, int y) {
+		if (x < 0 || y < 0) return;
+
+		terrainLayer.ClearTile(x, y);
+		itemLayer.ClearTile(x, y);
+		canvasLayers.Invalidate();
+
+		sf::Vector2i rect;
+		for (const auto& tile : levelTiles) {
+			if (tile.x != x || tile.y != y) continue;
+
+			if (GetTerrainTile(tile.tileCharacter, rect)) terrainLayer.SetTile(x, y, rect.x, rect.y);
+			else if (GetItemTile(tile.tileCharacter, true, rect)) itemLayer.SetTile(x, y, rect.x, rect.y);
+		}
+	}
+
+	void BuildLayers() {
+		const sf::Texture& tileset = AssetHolder::Get().GetTexture("Tileset");
+		terrainLayer.Reset(tileset, (uint32_t)nLineHeight + 1, (uint32_t)nLineWidth + 1, pixelSize);
+		itemLayer.Reset(tileset, (uint32_t)nLineHeight + 1, (uint32_t)nLineWidth + 1, pixelSize);
+
+		sf::Vector2i rect;
+		for (const auto& tile : levelTiles) {
+			if (tile.x < 0 || tile.y < 0) continue;
+
+			if (GetTerrainTile(tile.tileCharacter, rect)) terrainLayer.SetTile(tile.x, tile.y, rect.x, rect.y);
+			else if (GetItemTile(tile.tileCharacter, true, rect)) itemLayer.SetTile(tile.x, tile.y, rect.x, rect.y);
+		}
+		canvasLayers.Invalidate();
+	}
+
 	void Run() {
 
 		isEditorRunState = true;
@@ -604,8 +749,6 @@ public:
 		: GameState(size) {
 		tileSet.setTexture(AssetHolder::Get().GetTexture("editorTileset"));
 		tileSet.setPosition((float)size.x - 5.0f * pixelSize, 0.0f);
-		tile.setTexture(AssetHolder::Get().GetTexture("Tileset"));
-		tile.setTextureRect(sf::IntRect((int)pixelSize, (int)pixelSize, (int)pixelSize, (int)pixelSize));
 
 		tilePixel.setSize({ pixelSize, pixelSize });
 		tilePixel.setFillColor(sf::Color(0, 100, 200, 100));
@@ -622,8 +765,20 @@ public:
 
 		playerPos = { -pixelSize, -pixelSize };
 
+		nLineWidth = 15;
+		nLineHeight = 11;
+
 		if (isEditorRunState) {
 			Level level = Level::LoadLevel("files/levels/EditorLevel.lvl");
+
+			//The canvas takes the size of the level run last, reading the file leaves an empty row after it
+			uint32_t nRows = level.GetHeight();
+			while (nRows > 0 && level.GetCharacter(0, nRows - 1) == '\0') nRows--;
+			if (level.GetWidth() > 2 && nRows > 2) {
+				nLineHeight = (int)level.GetWidth() - 1;
+				nLineWidth = (int)nRows - 1;
+			}
+
 			for (uint32_t i = 1; i < level.GetHeight() - 1; i++) {
 				for (uint32_t j = 1; j < level.GetWidth() - 1; j++) {
 					if (level.GetCharacter(j, i) == '.') {
@@ -664,13 +819,27 @@ public:
 			}
 		}
 
-		nLineWidth = 15;
-		nLineHeight = 11;
-
 		tileSetWidth = 5;
 		tileSetOffset = 11;
 
 		index = 0;
+
+		BuildLayers();
+
+		canvasView = sf::View(sf::FloatRect(0.0f, 0.0f, (float)size.x, (float)size.y));
+		scroll = { 0.0f, 0.0f };
+
+		//Grid & tiles are drawn through the scrolled view
+		canvasLayers.Create(size);
+		canvasLayers.AddLayer([this](sf::RenderTarget& target) {
+			target.setView(canvasView);
+			DrawGrid(target, pixelSize, pixelSize, nLineHeight * pixelSize, nLineWidth * pixelSize);
+			terrainLayer.Render(target);
+			itemLayer.Render(target);
+			target.setView(target.getDefaultView());
+		});
+
+		Scroll(0, 0);
 	}
 
 	void ManageEvent(sf::Event e, sf::Vector2f mousePos) override {
@@ -690,6 +859,22 @@ public:
 					Run();
 				}
 				break;
+			case sf::Keyboard::Left:
+				if (isKeyPressed) Resize(-1, 0);
+				else Scroll(-1, 0);
+				break;
+			case sf::Keyboard::Right:
+				if (isKeyPressed) Resize(1, 0);
+				else Scroll(1, 0);
+				break;
+			case sf::Keyboard::Up:
+				if (isKeyPressed) Resize(0, -1);
+				else Scroll(0, -1);
+				break;
+			case sf::Keyboard::Down:
+				if (isKeyPressed) Resize(0, 1);
+				else Scroll(0, 1);
+				break;
 			case sf::Keyboard::Escape:
 				state = State::Menu;
 				isStateChanged = true;
@@ -723,7 +908,7 @@ public:
 	void Input() override {
 
 		if (MouseButton(sf::Mouse::Left)) {
-			auto [x, y] = (sf::Vector2i)(mousePosition / pixelSize);
+			auto [x, y] = GetCell(mousePosition);
 
 			if (x > 0 && y > 0 && x < nLineHeight && y < nLineWidth) {
 
@@ -732,9 +917,10 @@ public:
 				}
 				else {
 
-					bool isTile = false;
+					bool isTile = false, isChanged = false;
 					for (auto& tiles : levelTiles) {
 						if (tiles.x == x && tiles.y == y) {
+							isChanged = isChanged || tiles.tileCharacter != tileCharacters[index];
 							tiles.tileCharacter = tileCharacters[index];
 							isTile = true;
 						}
@@ -742,18 +928,22 @@ public:
 
 					if (!isTile) {
 						levelTiles.emplace_back(x, y, tileCharacters[index]);
+						isChanged = true;
 					}
+
+					if (isChanged) PatchCell(x, y);
 				}
 			}
 		}
 
 		if (MouseButton(sf::Mouse::Right)) {
-			auto [x, y] = (sf::Vector2i)(mousePosition / pixelSize);
+			auto [x, y] = GetCell(mousePosition);
 
 			if (x > 0 && y > 0 && x < nLineHeight && y < nLineWidth) {
 				for (auto it = levelTiles.begin(); it != levelTiles.end();) {
 					if (it->x == x && it->y == y) {
 						it = levelTiles.erase(it);
+						PatchCell(x, y);
 						break;
 					}
 					else {
@@ -766,68 +956,14 @@ public:
 
 	void Logic(float dt) override {
 
-		auto [x, y] = (sf::Vector2i)(mousePosition / pixelSize);
-
-		tilePixel.setPosition(x * pixelSize, y * pixelSize);
-	}
+		auto [x, y] = GetCell(mousePosition);
 
-	void SetRect(int x, int y) {
-		tile.setTextureRect(sf::IntRect(x * (int)pixelSize, y * (int)pixelSize, (int)pixelSize, (int)pixelSize));
+		tilePixel.setPosition(x * pixelSize - scroll.x, y * pixelSize - scroll.y);
 	}
 
 	void Render(sf::RenderWindow& window) {
 
-		DrawGrid(window, pixelSize, pixelSize, nLineHeight * pixelSize, nLineWidth * pixelSize);
-
-		for (auto& tiles : levelTiles) {
-			switch (tiles.tileCharacter) {
-			case '#':
-				SetRect(1, 1);
-				break;
-			case '1':
-				SetRect(0, 0);
-				break;
-			case '2':
-				SetRect(1, 0);
-				break;
-			case '3':
-				SetRect(2, 0);
-				break;
-			case '4':
-				SetRect(2, 1);
-				break;
-			case '5':
-				SetRect(2, 2);
-				break;
-			case '6':
-				SetRect(1, 2);
-				break;
-			case '7':
-				SetRect(0, 2);
-				break;
-			case '8':
-				SetRect(0, 1);
-				break;
-			case '9':
-				SetRect(3, 0);
-				break;
-			case 'W':
-				SetRect(4, 0);
-				break;
-			case 'B':
-				SetRect(3, 1);
-				break;
-			case 'T':
-				SetRect(4, 2);
-				break;
-			case '.':
-				continue;
-				break;
-			}
-
-			tile.setPosition(tiles.x * pixelSize, tiles.y * pixelSize);
-			window.draw(tile);
-		}
+		canvasLayers.Render(window);
 
 		if (isTileSetDrawn) {
 			window.draw(tileSet);
@@ -836,8 +972,8 @@ public:
 
 		window.draw(tilePixel);
 
-		RenderText(window, AssetHolder::Get().GetFont("lucidaConsole"), playerPos.x, playerPos.y, "P");
-		RenderText(window, AssetHolder::Get().GetFont("lucidaConsole"), 0.0f, 0.0f, "Place Player - Ctrl + LMB\nRun - Ctrl + R", sf::Color::White, 16);
+		RenderText(playerText, window, AssetHolder::Get().GetFont("lucidaConsole"), playerPos.x - scroll.x, playerPos.y - scroll.y, "P");
+		RenderText(helpText, window, AssetHolder::Get().GetFont("lucidaConsole"), 0.0f, 0.0f, "Place Player - Ctrl + LMB\nRun - Ctrl + R\nScroll - Arrows, Resize - Ctrl + Arrows", sf::Color::White, 16);
 	}
 };
 
@@ -897,6 +1033,7 @@ private:
 	sf::Sprite background, musicToggler;
 
 	Transition transitionEffect;
+	CachedText creditText;
 
 	bool isBackgroundDrawn;
 	int button;
@@ -1003,7 +1140,7 @@ public:
 			musicToggler.setTextureRect(sf::IntRect((int)!isMusicPlaying * 64, 0, 64, 64));
 			window.draw(musicToggler);
 
-			RenderText(window, AssetHolder::Get().GetFont("lucidaConsole"), 335.0f, (float)windowSize.y - 25.0f, "A Game by Megarev", sf::Color::White, 16);
+			RenderText(creditText, window, AssetHolder::Get().GetFont("lucidaConsole"), 335.0f, (float)windowSize.y - 25.0f, "A Game by Megarev", sf::Color::White, 16);
 		}
 
 		if (transitionEffect.GetTransition()) {
@@ -1012,750 +1149,299 @@ public:
 	}
 };
 
-class Box {
+class PauseUI {
 private:
-	sf::Vector2f resetPosition, position;
-	bool isValue;
+	sf::RectangleShape pauseScreen;
+	sf::Sprite musicToggler;
+	sf::Color color1, color2;
+	CachedText titleText, quitText;
+
+	bool isPaused;
 public:
-	Box() {}
-	Box(const sf::Vector2f& pos)
-		: resetPosition(pos), position(pos) {
-		isValue = true;
-	}
+	PauseUI() {}
+	PauseUI(const sf::Vector2u& size) {
+		pauseScreen.setSize((sf::Vector2f)size);
+		pauseScreen.setFillColor(sf::Color(255, 255, 255, 100));
+		
+		color1 = sf::Color(150 + rand() % 100, 150 + rand() % 100, 150 + rand() % 100);
+		color2 = sf::Color(150 + rand() % 100, 150 + rand() % 100, 150 + rand() % 100);
 
-	void Logic(Level& level, const sf::Vector2f& playerPos, const sf::Vector2f& direction) {
+		musicToggler.setTexture(AssetHolder::Get().GetTexture("soundToggler"));
+		musicToggler.setTextureRect(sf::IntRect(0, 0, 64, 64));
+		musicToggler.setPosition(0.0f, (float)size.y - 64);
+
+		isPaused = false;
+	}
 
-		auto [x, y] = (sf::Vector2i)(position / pixelSize);
+	void Render(sf::RenderWindow& window) {
+		if (isPaused) {
+			window.draw(pauseScreen);
+			RenderText(titleText, window, AssetHolder::Get().GetFont("lucidaConsole"), 
+				pauseScreen.getSize().x / 2.0f - 100.0f, pauseScreen.getSize().y / 2.0f - 100.0f, "Game Paused", color1);
+			RenderText(quitText, window, AssetHolder::Get().GetFont("lucidaConsole"), 
+				pauseScreen.getSize().x / 2.0f - 130.0f, pauseScreen.getSize().y / 2.0f - 20.0f, isEditorRunState ? "Press Q to Editor" : "Press Q to Menu", color2);
+		
+			musicToggler.setTextureRect(sf::IntRect((int)!isMusicPlaying * 64, 0, 64, 64));
+			window.draw(musicToggler);
+		}
+	}
 
-		if (isValue) {
-			if (position == playerPos) {
-				if (level.GetCharacter(x + (int)direction.x, y + (int)direction.y) == '#') {
-					position += direction * pixelSize;
+	void Logic(sf::Event e) {
+		switch (e.type) {
+		case sf::Event::MouseButtonPressed:
+			switch (e.key.code) {
+			case sf::Mouse::Left:
+				if (isPaused && GetIsMusicTogglerPressed((float)e.mouseButton.x, (float)e.mouseButton.y)) {
+					isMusicPlaying = !isMusicPlaying;
 				}
+				break;
+			}
+			break;
+		case sf::Event::KeyPressed:
+			switch (e.key.code) {
+			case sf::Keyboard::Escape:
+				isPaused = !isPaused;
+				color1 = sf::Color(150 + rand() % 100, 150 + rand() % 100, 150 + rand() % 100);
+				color2 = sf::Color(150 + rand() % 100, 150 + rand() % 100, 150 + rand() % 100);
+				break;
 			}
+			break;
 		}
 	}
 
-	void Reset() { 
-		position = resetPosition; 
-		isValue = true;
+	inline bool GetIsMusicTogglerPressed(float x, float y) const {
+		return musicToggler.getGlobalBounds().contains(x, y);
 	}
-	inline bool GetIsValue() const { return isValue; }
-	void SetIsValue(bool state) { isValue = state; }
-	inline sf::Vector2f GetPosition() const { return position; }
+
+	inline int GetIsPaused() const { return isPaused; }
+	void SetPauseState(bool state) { isPaused = state; }
 };
 
-class ToggleTile {
+class PlayState : public GameState {
 private:
-	sf::Vector2f position;
-	bool isTileActive;
-public:
-	ToggleTile() {}
-	ToggleTile(const sf::Vector2f& pos)
-		: position(pos) {
-		isTileActive = false;
-	}
+	LevelManager levelManager; //Level Manager
+	TextManager textManager; //Text Manager
+	sf::RectangleShape textBox;
 
-	void Logic(const std::vector<Box>& boxes) {
-		for (auto& box : boxes) {
+	Transition transitionScreen; //Transition between levels
+	PauseUI pauseUI;
+	int nPress;
 
-			isTileActive = false;
+	sf::Sprite spriteTile, background;
+	TileLayer terrainLayer, itemLayer, toggleLayer; //Built once per level, only the quads of cells that change are patched
+	Compositor sceneLayers;							//Background, terrain & items under the entities
+	Compositor frontLayers;							//Help text box & console frame over them
+	std::vector<Cell> winCells; //Their tile shows whether the level can be won
+	bool isWinOpen;
+	sf::View camera;		   //Board & entities are drawn through it, the texts & buttons are not
+	sf::Vector2f cameraOrigin; //Top left of the board in view
+
+	World world;
+	sf::Sprite playerSprite;		  //Drawn where the world has each player
+	std::vector<sf::Color> playerTints; //Colors of the players after the first
+	sf::RectangleShape opponentShape; //Drawn where the world has the opponent
 
-			if (position == box.GetPosition()) {
-				isTileActive = true;
-				break;
-			}
-		}
-	}
+	TextWindow textWindow;
+	gui::SpriteButton runButton, clearButton;
+	sf::Text text;
+	CachedText speedLabel, movesLabel;
+	CachedText runningLabel, abortedLabel, pausedLabel, runHintLabel, replayHintLabel; //Status line, one text each
 
-	void Reset() { isTileActive = false; }
-	void SetPosition(const sf::Vector2f& pos) { position = pos; }
-	inline bool GetIsTileActive() const { return isTileActive; }
-	void SetIsTileActive(bool isActive) { isTileActive = isActive; }
-	inline sf::Vector2f GetPosition() const { return position; }
-};
+	bool isButtonPressable, isHowToPlay, isKeyPressed;
+	bool isInterpreting; //Program is between moves and has used up the frame's instruction budget
+	bool isOutcomePending; //A campaign run was started and its outcome is not in the replay yet
+	bool isFastForward; //Skipping the animation to the end of the run
+	std::vector<std::string> runStrings; //Program of the current run, the console may change while it plays
 
-class Opponent {
-private:
-	sf::Vector2f resetPos, pos;
-	std::vector<sf::Vector2i> movePositions;
-	std::vector<std::string> movePos; //Read from a text file
-	sf::RectangleShape box;
-	int nLevel, index, direction;
-public:
-	Opponent() {
-		nLevel = 0;
-		index = 0;
-		direction = 1;
+	Replay replay;			//Last campaign run, its digests are taken from the live run as its moves are played
+	WorldState replayState;
+	bool isReplayReady;		//The run ended & F9 saves it
 
-		box.setSize({ pixelSize, pixelSize });
-		box.setFillColor(sf::Color::Magenta);
-		box.setOutlineColor(sf::Color(255, 100, 100));
-		box.setOutlineThickness(-2.0f);
-	}
+	Debugger debugger;
+	bool isDebugPaused; //The run waits for single steps (F6 toggles, F7 steps back, F8 steps forward)
+	bool isStepPending; //F8 was pressed & the step runs on, a frame's instruction budget at a time, until the next move
 
-	void SetResetPos(const sf::Vector2f& initPos) {
-		resetPos = initPos;
-		pos = initPos;
+	sf::Clock clock;
+	int t, delay;
+	uint32_t instructionBudget; //Instructions interpreted per frame at most
 
-		box.setPosition(resetPos);
-	}
+	//Playback runs on a fixed timestep: a move every delay / speed milliseconds, several per frame when that is shorter
+	Slider speedSlider;
+	std::vector<float> speeds; //Multipliers of the base speed, the last one runs as many moves as a frame's budget allows
+	std::size_t speedIndex;
+	std::string speedText; //Built again only when the slider picks another speed
+	float accumulator; //Milliseconds of playback not simulated yet
 
-	void Reset() {
-		index = 0;
-		direction = 1;
-		pos = resetPos;
-		box.setPosition(resetPos);
-	}
+	uint64_t runningCount; //Instruction count shown by runningText
+	std::string runningText;
 
-	void ClearMovePositions() {
-		movePositions.clear();
-	}
+	inline bool IsMaxSpeed() const { return speedIndex + 1 == speeds.size(); }
 
-	void LoadMovePositions(const std::string& filename) {
-		std::ifstream reader(filename);
+	//Picks the speed nearest to the slider's knob
+	void SetSpeed(int sliderValue) {
+		int length = std::max(speedSlider.GetLength(), 1);
+		std::size_t newIndex = (std::size_t)((sliderValue * (int)(speeds.size() - 1) + length / 2) / length);
+		if (newIndex == speedIndex && !speedText.empty()) return;
 
-		if (reader.is_open()) {
+		speedIndex = newIndex;
+		speedText = GetSpeedText();
+	}
 
-			while (!reader.eof()) {
-				std::string str;
-				reader >> str;
-				movePos.push_back(str);
-			}
+	std::string GetSpeedText() const {
+		if (IsMaxSpeed()) return "Speed max";
 
-			reader.close();
-		}
+		std::ostringstream stream;
+		stream << "Speed " << speeds[speedIndex] << "x";
+		return stream.str();
 	}
 
-	void IntrepretPositions() {
-		const std::string& directions = movePos[nLevel];
+	//Digests the world after a move played one by one, the replay only covers the moves from the start up to one
+	//the debugger did not see (such as a skip to the end), and drops those undone by a step back
+	void RecordMove() {
+		if (isEditorRunState) return;
 
-		for (char c : directions) {
-			switch (c) {
-			case '0': //Right
-				movePositions.push_back({ 1, 0 });
-				break;
-			case '1': //Down
-				movePositions.push_back({ 0, 1 });
-				break;
-			case '2': //Left
-				movePositions.push_back({ -1, 0 });
-				break;
-			case '3': //Up
-				movePositions.push_back({ 0, -1 });
-				break;
-			}
-		}
+		std::size_t nMoves = debugger.GetMoveCount();
+		replay.Truncate(nMoves);
+		if (nMoves != replay.GetDigestCount() + 1) return;
 
-		nLevel++;
-		if (nLevel >= (int)movePos.size()) nLevel = (int)(movePos.size());
+		world.GetState(replayState);
+		replay.AddMove(replayState);
 	}
 
-	void Move(const sf::Vector2f& playerPos) {
+	//Plays the moves due this frame, the run keeps its place when the frame's instruction budget runs out
+	void Play(int time) {
+		const float tick = delay / (IsMaxSpeed() ? 1.0f : speeds[speedIndex]);
 
-		sf::Vector2f newPos = pos + (sf::Vector2f)movePositions[index] * pixelSize * (float)direction;
-		if (newPos != playerPos) {
-			pos += (sf::Vector2f)movePositions[index] * pixelSize * (float)direction;
-			index += direction;
-		}
-
-		if (index >= (int)movePositions.size() || index < 0) {
-			if (index >= (int)movePositions.size()) index = (int)(movePositions.size() - 1);
-			else if (index < 0) index = 0;
-			direction = -direction;
-		}
+		//A long frame (such as dragging the window) catches up a few moves instead of jumping ahead
+		accumulator = std::min(accumulator + (float)time, 8.0f * tick);
 
-		box.setPosition(pos);
-	}
+		const uint64_t start = world.GetInstructionCount();
+		while (world.GetIsRun() && (IsMaxSpeed() || accumulator >= tick)) {
+			uint64_t used = world.GetInstructionCount() - start;
+			if (used >= instructionBudget) break;
 
-	void Render(sf::RenderWindow& window) {
-		window.draw(box);
-	}
+			Yield yield = debugger.Step(world, instructionBudget - (uint32_t)used);
+			isInterpreting = yield == Yield::Pending;
 
-	inline sf::Vector2f GetPosition() const { return pos; }
-};
+			//A pending program resumes on the next frame
+			if (isInterpreting) break;
+			if (yield == Yield::Move) RecordMove();
 
-class Player {
-private:
-	sf::Vector2f resetPlayerPos, playerPos;
-	sf::Sprite sprite;
-	std::vector<std::pair<sf::Vector2i, int>> movePositions;
-	std::vector<sf::Vector2i> changedTiles;
-	int index, nMoves, direction;
-	bool isIndex, isWin; //isIndex -> index == (movePositions.size - 1) & isWin -> has player won a level
-
-	void IntrepretMovement(const std::string& text) {
-		if (text == "fd") { //Move forward
-			switch (direction) {
-			case 0: //Right
-				AddMovePosition(1, 0);
-				break;
-			case 1: //Down
-				AddMovePosition(0, 1);
-				break;
-			case 2: //Left
-				AddMovePosition(-1, 0);
-				break;
-			case 3: //Up
-				AddMovePosition(0, -1);
-				break;
-			}
-		}
-		else if (text == "bk") { //Move backward
-			switch (direction) {
-			case 0: //Right
-				AddMovePosition(-1, 0);
-				break;
-			case 1: //Down
-				AddMovePosition(0, -1);
-				break;
-			case 2: //Left
-				AddMovePosition(1, 0);
-				break;
-			case 3: //Up
-				AddMovePosition(0, 1);
-				break;
-			}
+			accumulator = std::max(accumulator - tick, 0.0f);
+			t = 0;
 		}
 	}
 
-	void IntrepretRotation(const std::string& text) {
-		if (text == "rt" || text == "right") {
-			direction++;
-			if (direction > 3) direction = 0;
-		}
-		else if (text == "lt" || text == "left") {
-			direction--;
-			if (direction < 0) direction = 3;
-		}
+	void PatchCell(uint32_t x, uint32_t y) {
+		const Board& board = world.GetBoard();
+		sf::Vector2i rect;
+
+		if (GetTerrainTile(board.GetTerrain(x, y), rect)) terrainLayer.SetTile(x, y, rect.x, rect.y);
+		else terrainLayer.ClearTile(x, y);
+
+		if (GetItemTile(board.GetItem(x, y), isWinOpen, rect)) itemLayer.SetTile(x, y, rect.x, rect.y);
+		else itemLayer.ClearTile(x, y);
 	}
 
-	std::size_t IntrepretLoop(const Level& level, bool& isRun, const std::vector<std::string>& strings, int nStartPoint, int nLoop) {
-		std::vector<std::string> stringsToLoop;
-		bool isLoopPoint = false;
-		int conditionalPoint = 0;
+	//The border of the board is never drawn
+	void BuildLayers() {
+		Board& board = world.GetBoard();
+		board.SetIsChangeKept(true);
 
-		for (int i = nStartPoint; i < (int)strings.size(); i++) {
+		const sf::Texture& tileset = AssetHolder::Get().GetTexture("Tileset");
+		terrainLayer.Reset(tileset, board.GetWidth(), board.GetHeight(), pixelSize);
+		itemLayer.Reset(tileset, board.GetWidth(), board.GetHeight(), pixelSize);
+		toggleLayer.Reset(tileset, board.GetWidth(), board.GetHeight(), pixelSize);
 
-			auto textForLoop = ToWords(strings[i]);
-			if (textForLoop.size() == 0) continue;
+		isWinOpen = world.GetIsAllTilesActive();
+		winCells.clear();
 
-			if (textForLoop[0] == "closeloop" || textForLoop[0] == "end") { //loop close
-				isLoopPoint = true;
-				break;
+		for (uint32_t i = 1; i + 1 < board.GetHeight(); i++) {
+			for (uint32_t j = 1; j + 1 < board.GetWidth(); j++) {
+				PatchCell(j, i);
+				if (board.GetItem(j, i) == 'W') winCells.push_back({ (int)j, (int)i });
 			}
+		}
 
-			if (textForLoop[0] == "if") conditionalPoint = i;
+		for (const auto& tile : world.GetTiles()) {
+			toggleLayer.SetTile(tile.GetPosition().x, tile.GetPosition().y, 4, 2);
+		}
+	}
 
-			else if (textForLoop[0] == "loop" || textForLoop[0] == "repeat") {
-				continue;
+	//Cells the run changed since the last frame, and the win tiles once the toggles open or close them
+	//Returns whether a cell was patched
+	bool PatchLayers() {
+		Board& board = world.GetBoard();
+		bool isPatched = false;
+
+		for (const auto& [x, y] : board.GetChanges()) {
+			if (x > 0 && y > 0 && (uint32_t)x + 1 < board.GetWidth() && (uint32_t)y + 1 < board.GetHeight()) {
+				PatchCell(x, y);
+				isPatched = true;
 			}
+		}
+		board.ClearChanges();
 
-			stringsToLoop.push_back(strings[i]);
+		if (world.GetIsAllTilesActive() != isWinOpen) {
+			isWinOpen = !isWinOpen;
+			for (const auto& cell : winCells) PatchCell(cell.x, cell.y);
+			isPatched = isPatched || !winCells.empty();
 		}
 
-		if (!isLoopPoint) return 0;
+		return isPatched;
+	}
 
-		for (int n = 0; n < nLoop; n++) {
-			int value = 0;
+	//Boards that fit the window stay at its top left, larger ones scroll to keep the first player in the part
+	//of the window left of the console & above the buttons
+	void UpdateCamera() {
+		const Board& board = world.GetBoard();
+		const sf::Vector2f area = { windowSize.x - 150.0f, windowSize.y - 80.0f };
+		const sf::Vector2f size = { board.GetWidth() * pixelSize, board.GetHeight() * pixelSize };
 
-			for (int i = 0; i < (int)stringsToLoop.size(); i++) {
+		sf::Vector2f focus = { 0.0f, 0.0f };
+		if (!world.GetPlayers().empty()) focus = ToPixels(world.GetPlayers()[0].GetPosition()) + sf::Vector2f(pixelSize, pixelSize) / 2.0f;
 
-				int stringIndex = i + value;
-				if (stringIndex > (int)(stringsToLoop.size() - 1)) break;
+		sf::Vector2f origin = { 0.0f, 0.0f };
+		if (size.x > windowSize.x) origin.x = std::clamp(focus.x - area.x / 2.0f, 0.0f, size.x - area.x);
+		if (size.y > windowSize.y) origin.y = std::clamp(focus.y - area.y / 2.0f, 0.0f, size.y - area.y);
+		if (origin.x == cameraOrigin.x && origin.y == cameraOrigin.y) return;
 
-				auto text = ToWords(stringsToLoop[stringIndex]);
-				if (text.size() == 0) continue;
+		cameraOrigin = origin;
+		camera.setCenter(origin.x + windowSize.x / 2.0f, origin.y + windowSize.y / 2.0f);
+		sceneLayers.Invalidate();
+	}
 
-				if (text[0] == "move") {
-					if (text.size() >= 2) {
-						IntrepretMovement(text[1]);
-					}
-				}
-				else if (text[0] == "turn") {
-					if (text.size() >= 2) {
-						IntrepretRotation(text[1]);
-					}
-				}
-				else if (text[0] == "if") {
-					int nLines = (int)IntrepretCheckConditional(level, strings, conditionalPoint);
-					value += nLines;
-				}
-			}
-		}
-
-		return stringsToLoop.size();
-	}
-
-	std::size_t IntrepretCheckConditional(const Level& level, const std::vector<std::string>& strings, int nStartPoint) {
-		std::vector<std::string> first, second;
-
-		bool isConditionSatisfied = true;
-		bool isFirstComplete = false;
-
-		for (int i = nStartPoint; i < (int)strings.size(); i++) {
-			auto text = ToWords(strings[i]);
-			if (text.size() == 0) continue;
-
-			if (text.size() >= 3) {
-				if (text[0] == "if" && text[1] == "fd" && text[2] == "empty") {
-					int x = (int)(playerPos.x / pixelSize), y = (int)(playerPos.y / pixelSize);
-					for (const auto& pos : movePositions) {
-						x += pos.first.x;
-						y += pos.first.y;
-					}
-
-					if (direction == 0) { isConditionSatisfied = (bool)(level.GetCharacter((uint32_t)x + 1, (uint32_t)y) == '#'); }
-					else if (direction == 1) { isConditionSatisfied = (bool)(level.GetCharacter((uint32_t)x, (uint32_t)y + 1) == '#'); }
-					else if (direction == 2) { isConditionSatisfied = (bool)(level.GetCharacter((uint32_t)x - 1, (uint32_t)y) == '#'); }
-					else if (direction == 3) { isConditionSatisfied = (bool)(level.GetCharacter((uint32_t)x, (uint32_t)y - 1) == '#'); }
-
-					continue;
-				}
-			}
-
-			if (text[0] == "else" || strings[i] == "else") {
-				isFirstComplete = true;
-				continue;
-			}
-
-			if (text[0] == "closeif" || text[0] == "endif") break;
-
-			if (!isFirstComplete) first.push_back(strings[i]);
-			else second.push_back(strings[i]);
-		}
-
-		std::size_t size = isConditionSatisfied ? first.size() : second.size();
-		for (int i = 0; i < (int)size; i++) {
-			auto text = ToWords(isConditionSatisfied ? first[i] : second[i]);
-			if (text.size() == 0) continue;
-
-			if (text[0] == "move") IntrepretMovement(text[1]);
-			else if (text[0] == "turn") IntrepretRotation(text[1]);
-		}
-
-		return first.size() + second.size() + 3;
-	}
-public:
-	Player() {
-		index = 0;
-		nMoves = 0;
-		isIndex = false;
-		isWin = false;
-
-		sprite.setTextureRect(sf::IntRect(direction * (int)pixelSize, 0, (int)pixelSize, (int)pixelSize));
-	}
-
-	void LoadSprite(const sf::Texture& texture) {
-		sprite.setTexture(texture);
-	}
-
-	void Move(std::vector<Box>& boxes, Opponent& o, Level& level) {
-		//Player coords in level
-		auto [x, y] = (sf::Vector2i)(playerPos / pixelSize);
-
-		if (movePositions.size() > 0) {
-
-			bool isMove = true;
-
-			//New Position of player in level
-			sf::Vector2i playerToLevelIndex = { x + movePositions[index].first.x, y + movePositions[index].first.y };
-			sf::Vector2f newPlayerPos = (sf::Vector2f)playerToLevelIndex * pixelSize;
-
-			for (auto& box : boxes) {
-				if (box.GetIsValue()) {
-
-					char boxChar = level.GetCharacter(playerToLevelIndex.x + movePositions[index].first.x,
-						playerToLevelIndex.y + movePositions[index].first.y);
-
-					if (newPlayerPos == box.GetPosition()) {
-						if (boxChar == '.') {
-							level.SetCharacter(playerToLevelIndex.x + movePositions[index].first.x,
-								playerToLevelIndex.y + movePositions[index].first.y, '#');
-
-							changedTiles.emplace_back(playerToLevelIndex.x + movePositions[index].first.x,
-								playerToLevelIndex.y + movePositions[index].first.y);
-
-							box.SetIsValue(false);
-							isMove = false;
-						}
-						if (boxChar != '#') {
-							isMove = false;
-						}
-					}
-				}
-			}
-
-			if (newPlayerPos == o.GetPosition()) {
-				isMove = false;
-				nMoves++;
-			}
-
-			sprite.setTextureRect(sf::IntRect(movePositions[index].second * (int)pixelSize, 0, (int)pixelSize, (int)pixelSize));
-			if (isMove && level.GetCharacter(playerToLevelIndex.x, playerToLevelIndex.y) == '#') {
-				nMoves++;
-				playerPos += sf::Vector2f(movePositions[index].first.x * pixelSize, movePositions[index].first.y * pixelSize);
-			}
-
-			index++;
-		}
-	}
-
-	void Run(const Level& level, bool& isRun, const std::vector<std::string>& strings) {
-		movePositions.clear();
-		//rotations.clear();
-
-		int value = 0;
-		for (int i = 0; i < (int)strings.size(); i++) {
-
-			//StringIndex ensures that looping & conditional strings are not re-read
-			int stringIndex = i + value;
-			if (stringIndex > (int)(strings.size() - 1)) break;
-
-			int x = 0, y = 0;
-			for (const auto& pos : movePositions) {
-				x += pos.first.x;
-				y += pos.first.y;
-			}
-
-			if (level.GetCharacter((uint32_t)x, (uint32_t)y) == 'W') {
-				isRun = true;
-				break;
-			}
-
-			auto text = ToWords(strings[stringIndex]);
-			if (text.size() == 0) continue;
-
-			if (text[0] == "move") {
-				if (text.size() >= 2) {
-					IntrepretMovement(text[1]);
-				}
-			}
-
-			if (text[0] == "turn") {
-				if (text.size() >= 2) {
-					IntrepretRotation(text[1]);
-					//rotations.push_back(direction);
-				}
-			}
-
-			if (text[0] == "if") {
-				int nLines = (int)IntrepretCheckConditional(level, strings, stringIndex) - 1;
-				value += nLines;
-			}
-
-			if (text[0] == "loop" || text[0] == "repeat") {
-				if (text.size() >= 2) {
-					int n = std::stoi(text[1]);
-
-					//nLines -> number of lines in loop
-					int nLines = (int)IntrepretLoop(level, isRun, strings, stringIndex, n);
-					value += nLines;
-				}
-			}
-		}
-	}
-
-	void Logic(Level& itemMap, bool& isRun, bool isWinTileActive, const std::vector<ToggleTile>& tiles) {
-		auto [x, y] = (sf::Vector2i)(playerPos / pixelSize);
-		auto [w, h] = sf::Vector2u(itemMap.GetWidth(), itemMap.GetHeight());
-
-		if (x < 0) x = 0;
-		if (y < 0) y = 0;
-		if (x > (int)(w - 1)) x = (int)(w - 1);
-		if (y > (int)(h - 1)) y = (int)(h - 1);
-
-		isWin = false;
-
-		switch (itemMap.GetLevel()[y][x]) {
-		case 'A':
-			itemMap.SetCharacter((unsigned)x, (unsigned)y, '#');
-			break;
-		case 'S':
-			movePositions.clear();
-			Reset();
-			break;
-		case 'W':
-			bool isTileIntrepreted = false;
-			int n = 0;
-			for (auto& tile : tiles) {
-				isTileIntrepreted = true;
-				if (tile.GetIsTileActive()) {
-					n++;
-				}
-				else {
-					break;
-				}
-			}
-
-			if ((n == (int)(tiles.size()) && !isWinTileActive) ||
-				(!isTileIntrepreted && isWinTileActive)) {
-				isWin = true;
-			}
-
-			break;
-		}
-
-		if (index > (int)(movePositions.size() - 1)) {
-			isRun = false;
-			isIndex = true;
-		}
-
-		sprite.setPosition(playerPos);
-	}
-
-	void AddMovePosition(int dirX, int dirY) {
-		movePositions.push_back({ { dirX, dirY }, direction });
-	}
-
-	void SetPosition(const sf::Vector2f& pos) {
-		playerPos = pos;
-		resetPlayerPos = pos;
-	}
-
-	void ResetWin() { isWin = false; }
-	void Reset() {
-		nMoves = 0;
-		isIndex = false;
-		index = 0;
-		ResetWin();
-		SetPosition(resetPlayerPos);
-		direction = 0;
-		sprite.setTextureRect(sf::IntRect(direction * (int)pixelSize, 0, (int)pixelSize, (int)pixelSize));
-	}
-
-	void Render(sf::RenderWindow& window) {
-		window.draw(sprite);
-	}
-
-	inline int GetNMoves() const { return nMoves; }
-	inline bool GetIsWin() const { return isWin; }
-	inline bool GetIsIndex() const { return isIndex; }
-	inline sf::Vector2f GetPosition() const { return playerPos; }
-	std::vector<sf::Vector2i> GetChangedTiles() const { return changedTiles; }
+	//The layers that only change with the level or a cell of the board draw into the compositors
+	void CreateCompositors() {
+		sceneLayers.Create(windowSize);
+		sceneLayers.AddLayer([this](sf::RenderTarget& target) { target.draw(background); });
+		sceneLayers.AddLayer([this](sf::RenderTarget& target) {
+			target.setView(camera);
+			terrainLayer.Render(target);
+			itemLayer.Render(target);
+			target.setView(target.getDefaultView());
+		});
 
-	std::vector<std::pair<sf::Vector2i, int>> GetMovePositions() const { return movePositions; }
-	sf::Vector2f GetCurrentMovePosition() {
-		int posIndex = index;
-		if (posIndex > (int)(movePositions.size() - 1)) {
-			posIndex = (int)(movePositions.size() - 1);
-		}
-		return (sf::Vector2f)movePositions[posIndex].first;
+		frontLayers.Create(windowSize);
+		frontLayers.AddLayer([this](sf::RenderTarget& target) {
+			target.draw(textBox);
+			if (!isEditorRunState) textManager.DrawTextHelp({ 0.0f, 0.0f, }, target);
+		});
+		frontLayers.AddLayer([this](sf::RenderTarget& target) {
+			textWindow.RenderBox(target);
+			DrawLine(target, windowSize.x - 150.0f, 30.0f, (float)windowSize.x, 30.0f);
+			text.setString("Console");
+			text.setPosition(windowSize.x - 130.0f, 0.0f);
+			target.draw(text);
+		});
 	}
-};
-
-typedef Level ItemMap;
-class LevelManager {
-private:
-
-	struct LevelData {
-		std::string level, itemMap;
-
-		LevelData(const std::string& levelStr, const std::string& itemMapStr)
-			: level(levelStr), itemMap(itemMapStr) {}
-	};
-
-	std::vector<LevelData> strings;
-	std::string folder, extension;
-
-	int index;
-
-	Level level;
-	ItemMap itemMap;
-	bool isWinTileActive;
-
-	void LoadLevel(std::string fileExtension = ".lvl") {
-		level = Level::LoadLevel(folder + strings[index].level + fileExtension);
-		itemMap = Level::LoadLevel(folder + strings[index].itemMap + fileExtension);
-	}
-public:
-	LevelManager() {
-		folder = "files/levels/";
-		extension = ".txt";
-		index = 0;
-
-		LoadLevelStrings("LevelStrings");
-	}
-
-	void LoadLevelStrings(const std::string& filename) {
-		std::ifstream reader(folder + filename + extension);
-
-		if (reader.is_open()) {
-
-			while (!reader.eof()) {
-				std::string levelName, itemMapName;
-				reader >> levelName >> itemMapName;
-				strings.emplace_back(levelName, itemMapName);
-			}
-
-			reader.close();
-		}
-
-		if ((int)strings.size() > 0) {
-			LoadLevel();
-		}
-	}
-
-	void LoadLevelFromFile(const std::string& filepath) {
-		level = Level::LoadLevel(filepath);
-	}
-
-	void LoadItemMap(const std::string& filepath) {
-		itemMap = ItemMap::LoadLevel(filepath);
-	}
-
-	Level& GetLevel() { return level; }
-	ItemMap& GetItemMap() {
-		return itemMap;
-	}
-	inline int GetIndex() const { return index; }
-	void SetIndex(int n) { 
-		index = n; 
-		LoadLevel();
-	}
-
-	void ResetIndex() { index = 0; }
-	void LoadNextLevel() {
-		++index %= (int)strings.size();
-		LoadLevel();
-	}
-};
-
-class PauseUI {
-private:
-	sf::RectangleShape pauseScreen;
-	sf::Sprite musicToggler;
-	sf::Color color1, color2;
-
-	bool isPaused;
-public:
-	PauseUI() {}
-	PauseUI(const sf::Vector2u& size) {
-		pauseScreen.setSize((sf::Vector2f)size);
-		pauseScreen.setFillColor(sf::Color(255, 255, 255, 100));
-		
-		color1 = sf::Color(150 + rand() % 100, 150 + rand() % 100, 150 + rand() % 100);
-		color2 = sf::Color(150 + rand() % 100, 150 + rand() % 100, 150 + rand() % 100);
-
-		musicToggler.setTexture(AssetHolder::Get().GetTexture("soundToggler"));
-		musicToggler.setTextureRect(sf::IntRect(0, 0, 64, 64));
-		musicToggler.setPosition(0.0f, (float)size.y - 64);
-
-		isPaused = false;
-	}
-
-	void Render(sf::RenderWindow& window) {
-		if (isPaused) {
-			window.draw(pauseScreen);
-			RenderText(window, AssetHolder::Get().GetFont("lucidaConsole"), 
-				pauseScreen.getSize().x / 2.0f - 100.0f, pauseScreen.getSize().y / 2.0f - 100.0f, "Game Paused", color1);
-			RenderText(window, AssetHolder::Get().GetFont("lucidaConsole"), 
-				pauseScreen.getSize().x / 2.0f - 130.0f, pauseScreen.getSize().y / 2.0f - 20.0f, "Press Q to " + (std::string)(isEditorRunState ? "Editor" : "Menu"), color2);
-		
-			musicToggler.setTextureRect(sf::IntRect((int)!isMusicPlaying * 64, 0, 64, 64));
-			window.draw(musicToggler);
-		}
-	}
-
-	void Logic(sf::Event e) {
-		switch (e.type) {
-		case sf::Event::MouseButtonPressed:
-			switch (e.key.code) {
-			case sf::Mouse::Left:
-				if (isPaused && GetIsMusicTogglerPressed((float)e.mouseButton.x, (float)e.mouseButton.y)) {
-					isMusicPlaying = !isMusicPlaying;
-				}
-				break;
-			}
-			break;
-		case sf::Event::KeyPressed:
-			switch (e.key.code) {
-			case sf::Keyboard::Escape:
-				isPaused = !isPaused;
-				color1 = sf::Color(150 + rand() % 100, 150 + rand() % 100, 150 + rand() % 100);
-				color2 = sf::Color(150 + rand() % 100, 150 + rand() % 100, 150 + rand() % 100);
-				break;
-			}
-			break;
-		}
-	}
-
-	inline bool GetIsMusicTogglerPressed(float x, float y) const {
-		return musicToggler.getGlobalBounds().contains(x, y);
-	}
-
-	inline int GetIsPaused() const { return isPaused; }
-	void SetPauseState(bool state) { isPaused = state; }
-};
-
-class PlayState : public GameState {
-private:
-	LevelManager levelManager; //Level Manager
-	TextManager textManager; //Text Manager
-	sf::RectangleShape textBox;
-
-	Transition transitionScreen; //Transition between levels
-	PauseUI pauseUI;
-	int nPress;
-
-	sf::Sprite spriteTile, background;
-
-	Player player;
-	Opponent opponent;
-
-	std::vector<Box> boxes;
-	std::vector<ToggleTile> tiles;
-
-	TextWindow textWindow;
-	gui::SpriteButton runButton, clearButton;
-	sf::Text text;
-
-	bool isRun, isButtonPressable, isHowToPlay, isToggleTileInLevel, isOpponentInLevel, isKeyPressed;
-
-	sf::Clock clock;
-	int t, delay;
 
 	void Initialize() {
+		world.Load(levelManager.GetLevel(), levelManager.GetItemMap(), levelManager.GetOpponentPath());
+		BuildLayers();
 
-		boxes.clear();
-		tiles.clear();
-		player.Reset();
-		opponent.Reset();
-		opponent.ClearMovePositions();
-		opponent.SetResetPos({ -pixelSize, -pixelSize });
-		isToggleTileInLevel = false;
-
-		ItemMap& map = levelManager.GetItemMap();
-		isOpponentInLevel = false;
-
-		for (uint32_t i = 1; i < map.GetHeight() - 1; i++) {
-			for (uint32_t j = 1; j < map.GetWidth() - 1; j++) {
-				char c = map.GetCharacter(j, i);
-
-				switch (c) {
-				case 'P': //Player Position
-					player.SetPosition({ j * pixelSize, i * pixelSize });
-					map.SetCharacter(j, i, '#');
-					break;
-				case 'B': //Box Position
-					boxes.push_back(Box({ j * pixelSize, i * pixelSize }));
-					map.SetCharacter(j, i, '#');
-					break;
-				case 'O': //Opponent Position
-					opponent.SetResetPos({ j * pixelSize, i * pixelSize });
-					map.SetCharacter(j, i, '#');
-					isOpponentInLevel = true;
-					break;
-				case 'T': //ToggleTile Position
-					tiles.push_back(ToggleTile({ j * pixelSize, i * pixelSize }));
-					map.SetCharacter(j, i, '#');
-					isToggleTileInLevel = true;
-					break;
-				}
-			}
-		}
-	
-		if (isOpponentInLevel) opponent.IntrepretPositions();
+		sceneLayers.Invalidate();
+		frontLayers.Invalidate();
 	}
 public:
 	PlayState(const sf::Vector2u& size)
@@ -1765,12 +1451,20 @@ public:
 		textWindow.SetFont(AssetHolder::Get().GetFont("lucidaConsole"));
 
 		spriteTile.setTexture(AssetHolder::Get().GetTexture("Tileset"));
-		player.LoadSprite(AssetHolder::Get().GetTexture("player"));
+		playerSprite.setTexture(AssetHolder::Get().GetTexture("player"));
+
+		opponentShape.setSize({ pixelSize, pixelSize });
+		opponentShape.setFillColor(sf::Color::Magenta);
+		opponentShape.setOutlineColor(sf::Color(255, 100, 100));
+		opponentShape.setOutlineThickness(-2.0f);
 		
 		transitionScreen = Transition((sf::Vector2f)size);
 		pauseUI = PauseUI(size);
 		nPress = 0;
 
+		camera = sf::View(sf::FloatRect(0.0f, 0.0f, (float)size.x, (float)size.y));
+		cameraOrigin = { 0.0f, 0.0f };
+
 		if (isEditorRunState) {
 			background.setTexture(AssetHolder::Get().GetTexture("background"));
 			levelManager.LoadLevelFromFile("files/levels/EditorLevel.lvl");
@@ -1803,13 +1497,25 @@ public:
 			}
 		}
 
-		opponent.LoadMovePositions("files/opponentPos.txt");
 		Initialize();
 
 		delay = 100; //Milliseconds
-
-		isRun = true;
-		player.Run(levelManager.GetLevel(), isRun, textWindow.GetStrings());
+		instructionBudget = 200000;
+		accumulator = 0.0f;
+		runningCount = 0;
+		t = 0;
+
+		speeds = { 0.25f, 0.5f, 1.0f, 2.0f, 4.0f, 8.0f, 16.0f, 32.0f, 0.0f };
+		playerTints = { sf::Color(140, 200, 255), sf::Color(255, 170, 120), sf::Color(170, 255, 150), sf::Color(240, 150, 240) };
+		speedSlider = Slider({ 250.0f, size.y - 66.0f }, { 96.0f, 4.0f }, 6.0f, sf::Color(150, 150, 150), sf::Color::White);
+		speedSlider.SetValue(speedSlider.GetLength() * 2 / (int)(speeds.size() - 1)); //1x
+		SetSpeed(speedSlider.GetValue());
+		isInterpreting = false;
+		isOutcomePending = false;
+		isReplayReady = false;
+		isFastForward = false;
+		isDebugPaused = false;
+		isStepPending = false;
 
 		isKeyPressed = false;
 		isButtonPressable = true;
@@ -1824,6 +1530,8 @@ public:
 		text.setFont(AssetHolder::Get().GetFont("lucidaConsole"));
 		text.setCharacterSize(25);
 
+		CreateCompositors();
+
 		music.openFromFile("files/sounds/gameBg.wav");
 		music.setLoop(true);
 		if (isMusicPlaying) music.play();
@@ -1841,6 +1549,7 @@ public:
 			if (isHowToPlay && !isEditorRunState) {
 				background.setTexture(AssetHolder::Get().GetTexture("background"));
 				isHowToPlay = false;
+				sceneLayers.Invalidate();
 			}
 			switch (e.key.code) {
 			case sf::Keyboard::Q:
@@ -1848,12 +1557,44 @@ public:
 					SetState(isEditorRunState ? State::Editor : State::Menu);
 				}
 				break;
+			case sf::Keyboard::F5:
+				if (world.GetIsRun()) {
+					isFastForward = true;
+					isDebugPaused = false;
+					debugger.Stop();
+				}
+				break;
+			case sf::Keyboard::F6:
+				if (!pauseUI.GetIsPaused() && !isButtonPressable) {
+					isDebugPaused = !isDebugPaused;
+					isStepPending = false;
+				}
+				break;
+			case sf::Keyboard::F7:
+				if (isDebugPaused && !pauseUI.GetIsPaused()) {
+					debugger.StepBack(world);
+					replay.Truncate(debugger.GetMoveCount());
+					isInterpreting = false;
+					isStepPending = false;
+				}
+				break;
+			case sf::Keyboard::F8:
+				if (isDebugPaused && !pauseUI.GetIsPaused()) isStepPending = true;
+				break;
+			case sf::Keyboard::F9:
+				if (isReplayReady && !pauseUI.GetIsPaused()) {
+					std::error_code error;
+					std::filesystem::create_directories("files/replays", error);
+					replay.Save("files/replays/last.rpl");
+				}
+				break;
 			}
 			break;
 		case sf::Event::MouseButtonPressed:
 			if (isHowToPlay) {
 				background.setTexture(AssetHolder::Get().GetTexture("background"));
 				isHowToPlay = false;
+				sceneLayers.Invalidate();
 			}
 
 			switch (e.key.code) {
@@ -1874,6 +1615,12 @@ public:
 
 		runButton.Logic(0, 0, e, mousePos);
 		clearButton.Logic(0, 1, e, mousePos);
+
+		if (!pauseUI.GetIsPaused() && sf::Mouse::isButtonPressed(sf::Mouse::Left) &&
+			(e.type == sf::Event::MouseMoved || e.type == sf::Event::MouseButtonPressed)) {
+			speedSlider.Logic(mousePos);
+			SetSpeed(speedSlider.GetValue());
+		}
 	}
 
 	void Logic(float dt) override {
@@ -1919,10 +1666,19 @@ public:
 		textWindow.Logic();
 
 		if (runButton.GetIsPressed() && isButtonPressable) {
-			isRun = true;
 			isButtonPressable = false;
+			isOutcomePending = !isEditorRunState; //Editor levels change between runs
+
+			runStrings = textWindow.GetStrings();
+			world.Run(runStrings);
+			debugger.Start(world);
+			isDebugPaused = false;
+			isStepPending = false;
 
-			player.Run(levelManager.GetLevel(), isRun, textWindow.GetStrings());
+			isReplayReady = false;
+			if (!isEditorRunState) {
+				replay.Start(levelManager.GetLevel(), levelManager.GetItemMap(), levelManager.GetOpponentPath(), levelManager.GetIndex(), runStrings);
+			}
 		}
 
 		if (clearButton.GetIsPressed()) textWindow.ResetStrings();
@@ -1931,44 +1687,53 @@ public:
 		clock.restart();
 		t += time;
 
-		if (isRun) {
-			if (t > delay) {
-
-				if (player.GetMovePositions().size() > 0) {
-
-					sf::Vector2f playerDirection = player.GetCurrentMovePosition();
-					player.Move(boxes, opponent, levelManager.GetLevel());
-					sf::Vector2f playerPos = player.GetPosition();
-
-					for (auto& box : boxes)
-						box.Logic(levelManager.GetLevel(), playerPos, playerDirection);
-
-					for (auto& tile : tiles)
-						tile.Logic(boxes);
-
-					if (isOpponentInLevel) opponent.Move(player.GetPosition());
-				}
-
+		if (isDebugPaused) {
+			//Single steps come from the keys, the end of the run waits for the debugger to let go
+			if (isStepPending && world.GetIsRun()) {
+				Yield yield = debugger.Step(world, instructionBudget);
+				isInterpreting = yield == Yield::Pending;
+				isStepPending = isInterpreting;
+				if (yield == Yield::Move) RecordMove();
+			}
+			else {
+				isStepPending = false;
+			}
+			accumulator = 0.0f;
+			t = 0;
+		}
+		else if (world.GetIsRun()) {
+			if (isFastForward) {
+				//Skipping still spends at most a frame's budget per frame
+				isInterpreting = !world.FastForward(instructionBudget);
+				isFastForward = isInterpreting;
+				accumulator = 0.0f;
 				t = 0;
 			}
+			else {
+				Play(time);
+			}
+		}
+		else {
+			isFastForward = false;
+			accumulator = 0.0f;
 		}
 
-		player.Logic(levelManager.GetItemMap(), isRun, !isToggleTileInLevel, tiles);
+		world.Logic();
 
-		if (player.GetIsWin() && t > 2 * delay) {
-			transitionScreen.SetTransition(true);
-		}
+		if (isOutcomePending && !world.GetIsRun() && t > 2 * delay) {
+			isOutcomePending = false;
 
-		if (t > 2 * delay && !player.GetIsWin()) {
-			for (auto& box : boxes) box.Reset();
-			for (auto& tile : tiles) tile.Reset();
+			//The last campaign run is kept as a replay to attach to support tickets
+			replay.SetOutcome(world.GetResult().outcome);
+			isReplayReady = true;
+		}
 
-			for (const auto& a : player.GetChangedTiles()) {
-				levelManager.GetLevel().SetCharacter(a.x, a.y, '.');
-			}
+		if (world.GetIsWin() && !world.GetIsRun() && t > 2 * delay) {
+			transitionScreen.SetTransition(true);
+		}
 
-			player.Reset();
-			if (isOpponentInLevel) opponent.Reset();
+		if (t > 2 * delay && !world.GetIsRun() && !world.GetIsWin()) {
+			world.Reset();
 			isButtonPressable = true;
 			t = 0;
 		}
@@ -1980,135 +1745,86 @@ public:
 
 	void Render(sf::RenderWindow& window) override {
 
-		//Background
-		window.draw(background);
-
-		if (isHowToPlay && !isEditorRunState) return;
-
-		for (int i = 1; i < (int)levelManager.GetLevel().GetHeight() - 1; i++) {
-			for (int j = 1; j < (int)levelManager.GetLevel().GetWidth() - 1; j++) {
-				switch (levelManager.GetLevel().GetCharacter(j, i)) {
-				case '#':
-					SetRect(1, 1);
-					break;
-				case '1':
-					SetRect(0, 0);
-					break;
-				case '2':
-					SetRect(1, 0);
-					break;
-				case '3':
-					SetRect(2, 0);
-					break;
-				case '4':
-					SetRect(2, 1);
-					break;
-				case '5':
-					SetRect(2, 2);
-					break;
-				case '6':
-					SetRect(1, 2);
-					break;
-				case '7':
-					SetRect(0, 2);
-					break;
-				case '8':
-					SetRect(0, 1);
-					break;
-				case '9':
-					SetRect(3, 0);
-					break;
-				case '.':
-					continue;
-					break;
-				}
-
-				spriteTile.setPosition(j * pixelSize, i * pixelSize);
-				window.draw(spriteTile);
-			}
+		if (isHowToPlay && !isEditorRunState) {
+			window.draw(background);
+			return;
 		}
 
-		for (int i = 1; i < (int)levelManager.GetItemMap().GetHeight() - 1; i++) {
-			for (int j = 1; j < (int)levelManager.GetItemMap().GetWidth() - 1; j++) {
-				switch (levelManager.GetItemMap().GetCharacter(j, i)) {
-				case '#':
-				case '.':
-					continue;
-					break;
-				case 'A':
-					SetRect(5, 0);
-					break;
-				case 'S':
-					SetRect(5, 1);
-					break;
-				case 'W':
-					bool isWinTileActive = !isToggleTileInLevel;
-					if (tiles.size() > 0) isWinTileActive = true;
-					for (auto& tile : tiles) {
-						if (!tile.GetIsTileActive()) {
-							isWinTileActive = false;
-							break;
-						}
-					}
-					SetRect(4, isWinTileActive ? 0 : 1);
-					break;
-				}
+		//Background, terrain & items
+		if (PatchLayers()) sceneLayers.Invalidate();
+		UpdateCamera();
+		sceneLayers.Render(window);
 
-				spriteTile.setPosition(j * pixelSize, i * pixelSize);
-				window.draw(spriteTile);
-			}
-		}
+		window.setView(camera);
 
-		//Player
-		player.Render(window);
+		//Players, the ones after the first are tinted to tell them apart
+		const std::vector<Player>& players = world.GetPlayers();
+		for (std::size_t i = 0; i < players.size(); i++) {
+			playerSprite.setColor(i == 0 ? sf::Color::White : playerTints[(i - 1) % playerTints.size()]);
+			playerSprite.setTextureRect(sf::IntRect(players[i].GetDirection() * (int)pixelSize, 0, (int)pixelSize, (int)pixelSize));
+			playerSprite.setPosition(ToPixels(players[i].GetPosition()));
+			window.draw(playerSprite);
+		}
+		playerSprite.setColor(sf::Color::White);
 
 		//Opponent
-		opponent.Render(window);
+		opponentShape.setPosition(ToPixels(world.GetOpponent().GetPosition()));
+		window.draw(opponentShape);
 
 		//Toggle Tile
-		for (auto& tile : tiles) {
-			spriteTile.setPosition(tile.GetPosition());
-			SetRect(4, 2);
-			window.draw(spriteTile);
-		}
+		toggleLayer.Render(window);
 
 		//Boxes
-		for (auto& box : boxes) {
+		for (auto& box : world.GetBoxes()) {
 			
 			if (box.GetIsValue()) {
 
-				bool isActive = false;
-				for (auto& tile : tiles) {
-					if (tile.GetPosition() == box.GetPosition()) {
-						isActive = true;
-						break;
-					}
-				}
+				Cell cell = box.GetPosition();
+				bool isActive = world.GetBoard().GetFlag(cell.x, cell.y, Board::ToggleTile);
 
 				SetRect(3, isActive ? 2 : 1);
-				spriteTile.setPosition(box.GetPosition());
+				spriteTile.setPosition(ToPixels(box.GetPosition()));
 				window.draw(spriteTile);
 			}
 		}
 
+		window.setView(window.getDefaultView());
+
 		//Buttons
 		runButton.Render(window);
 		clearButton.Render(window);
 
-		//Text
-		window.draw(textBox);
-		if (!isEditorRunState) {
-			textManager.DrawTextHelp({ 0.0f, 0.0f, }, window);
-		}
+		//Speed
+		RenderText(speedLabel, window, AssetHolder::Get().GetFont("lucidaConsole"), 160.0f, (windowSize.y - 74.0f), speedText, sf::Color::White, 16);
+		speedSlider.Render(window);
+
+		//Text & the console frame
+		frontLayers.Render(window);
 
 		//TextWindow
 		textWindow.Render(window);
-		DrawLine(window, windowSize.x - 150.0f, 30.0f, (float)windowSize.x, 30.0f);
-		text.setString("Console");
-		text.setPosition(windowSize.x - 130.0f, 0.0f);
-		window.draw(text);
 
-		DrawTextWithValue(window, AssetHolder::Get().GetFont("lucidaConsole"), 160.0f, (windowSize.y - 32.0f), "Moves :", player.GetNMoves(), sf::Color::White, 25);
+		DrawTextWithValue(movesLabel, window, AssetHolder::Get().GetFont("lucidaConsole"), 160.0f, (windowSize.y - 32.0f), "Moves :", world.GetNMoves(), sf::Color::White, 25);
+
+		if (isInterpreting) {
+			if (world.GetInstructionCount() != runningCount || runningText.empty()) {
+				runningCount = world.GetInstructionCount();
+				runningText = "Running " + std::to_string(runningCount);
+			}
+			RenderText(runningLabel, window, AssetHolder::Get().GetFont("lucidaConsole"), 160.0f, (windowSize.y - 52.0f), runningText, sf::Color::Yellow, 16);
+		}
+		else if (world.GetIsAborted()) {
+			RenderText(abortedLabel, window, AssetHolder::Get().GetFont("lucidaConsole"), 160.0f, (windowSize.y - 52.0f), "Aborted: too long", sf::Color::Red, 16);
+		}
+		else if (isDebugPaused) {
+			RenderText(pausedLabel, window, AssetHolder::Get().GetFont("lucidaConsole"), 160.0f, (windowSize.y - 52.0f), "Paused: F7 / F8 step", sf::Color::Yellow, 16);
+		}
+		else if (world.GetIsRun()) {
+			RenderText(runHintLabel, window, AssetHolder::Get().GetFont("lucidaConsole"), 160.0f, (windowSize.y - 52.0f), "F5 skip  F6 pause", sf::Color::White, 16);
+		}
+		else if (isReplayReady) {
+			RenderText(replayHintLabel, window, AssetHolder::Get().GetFont("lucidaConsole"), 160.0f, (windowSize.y - 52.0f), "F9 save replay", sf::Color::White, 16);
+		}
 
 		if (transitionScreen.GetTransition()) {
 			transitionScreen.Render(window);
@@ -2130,9 +1846,11 @@ private:
 	sf::Clock clock;
 	float initDt;
 	bool showFPS;
+	CachedText fpsText;
 
 	void LoadAssets() {
 		AssetHolder::Get().AddFont("lucidaConsole", "files/fonts/Lucida_Console.ttf");
+		PrewarmGlyphs(AssetHolder::Get().GetFont("lucidaConsole"), { 15, 16, 25, 32 }); //Console, hints & help, counters, titles
 		AssetHolder::Get().AddTexture("Tileset", "files/images/Tileset.png");
 		AssetHolder::Get().AddTexture("editorTileset", "files/images/editorTileset.png");
 		AssetHolder::Get().AddTexture("buttons", "files/images/buttons.png");
@@ -2237,7 +1955,7 @@ public:
 			Window.clear();
 			currentGameState->Render(Window);
 			if (showFPS) {
-				DrawTextWithValue(Window, AssetHolder::Get().GetFont("lucidaConsole"), 0.0f, 0.0f, "FPS :", (int)(1.0f / frameDt));
+				DrawTextWithValue(fpsText, Window, AssetHolder::Get().GetFont("lucidaConsole"), 0.0f, 0.0f, "FPS :", (int)(1.0f / frameDt));
 			}
 			Window.display();
 		}
@@ -0,0 +1,56 @@
+#include "ChunkedGrid.h"
+#include <iostream>
+
+static int nFailed = 0;
+
+static void Check(bool isPassed, const char* what) {
+	if (isPassed) return;
+	std::cerr << "failed: " << what << "\n";
+	nFailed++;
+}
+
+//Reads & writes on a grid of 4 x 4 chunks whose size is not a whole number of chunks, against a flat copy
+int main() {
+	const uint32_t width = 10, height = 7;
+	ChunkedGrid<int, 2> grid;
+	grid.Reset(width, height, -1);
+	std::vector<int> flat(width * height, -1);
+
+	Check(grid.GetChunkCount() == 0 && grid.Get(9, 6) == -1, "empty grid reads its fill");
+
+	//Writing the fill into a chunk never written keeps it unallocated
+	grid.Set(5, 5, -1);
+	Check(grid.GetChunkCount() == 0 && !grid.GetIsPainted(5, 5), "fill write allocates nothing");
+
+	//Cells on both sides of every chunk edge, and the last partial chunks
+	const uint32_t cells[][2] = { { 3, 0 }, { 4, 0 }, { 3, 3 }, { 4, 4 }, { 7, 3 }, { 8, 3 }, { 9, 6 } };
+	int value = 0;
+	for (const auto& cell : cells) {
+		grid.Set(cell[0], cell[1], value);
+		flat[cell[1] * width + cell[0]] = value;
+		value++;
+	}
+
+	bool isEqual = true;
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) isEqual = isEqual && grid.Get(x, y) == flat[y * width + x];
+	}
+	Check(isEqual, "cells read back as written");
+	Check(grid.GetChunkCount() == 5, "one chunk for each written block");
+	Check(!grid.GetIsPainted(1, 5) && grid.GetIsPainted(8, 0), "painted chunks");
+
+	//Runs end at the chunk's edge, unallocated chunks read a row of fill
+	uint32_t n = 0;
+	const int* run = grid.GetRun(2, 3, n);
+	Check(n == 2 && run[0] == -1 && run[1] == 2, "run to the chunk edge");
+	run = grid.GetRun(1, 5, n);
+	Check(n == 3 && run[0] == -1 && run[2] == -1, "run of fill");
+
+	grid.At(1, 1) += 10;
+	Check(grid.Get(1, 1) == 9 && grid.GetChunkCount() == 5, "writable cell in an allocated chunk");
+
+	grid.Reset(width, height, 7);
+	Check(grid.GetChunkCount() == 0 && grid.Get(4, 4) == 7, "reset drops every chunk");
+
+	return nFailed == 0 ? 0 : 1;
+}
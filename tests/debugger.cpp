@@ -0,0 +1,65 @@
+#include "Debugger.h"
+#include "Replay.h"
+#include "LevelManager.h"
+#include <iostream>
+
+static int nFailed = 0;
+
+static void Check(bool isPassed, const char* what) {
+	if (isPassed) return;
+	std::cerr << "failed: " << what << "\n";
+	nFailed++;
+}
+
+static uint32_t GetDigest(const World& world) {
+	WorldState state;
+	world.GetState(state);
+	return Replay::Digest(state);
+}
+
+//Steps a run forwards keeping the state after each move, then back through the snapshot ring to where it started
+//Run from the game folder so files/ is found
+int main() {
+	LevelManager levelManager;
+	if (levelManager.GetLevelCount() == 0) {
+		std::cerr << "no levels found\n";
+		return 1;
+	}
+	levelManager.SetIndex(0);
+
+	const std::vector<std::string> strings = { "repeat 150", "move fd", "turn rt", "move fd", "turn lt", "end" };
+	World world;
+	world.Load(levelManager.GetLevel(), levelManager.GetItemMap(), levelManager.GetOpponentPath());
+	world.Run(strings);
+
+	Debugger debugger(4, 8);
+	debugger.Start(world);
+
+	std::vector<uint32_t> digests = { GetDigest(world) }; //After each move, the start first
+	while (world.GetIsRun() && digests.size() <= 20) {
+		if (debugger.Step(world, UINT32_MAX) == Yield::Move) digests.push_back(GetDigest(world));
+	}
+	Check(debugger.GetMoveCount() == 20, "moves counted");
+
+	//The ring holds 8 snapshots, every 4 moves, so the whole run is still covered
+	bool isEqual = true;
+	while (debugger.GetMoveCount() > 0) {
+		Check(debugger.GetIsStepBackPossible(), "step back possible");
+		Check(debugger.StepBack(world), "stepped back");
+		isEqual = isEqual && GetDigest(world) == digests[debugger.GetMoveCount()];
+	}
+	Check(isEqual, "each step back restores the state after the move before");
+	Check(!debugger.StepBack(world), "no step back past the start");
+
+	//A longer run pushes the oldest snapshots out, stepping back stops at the oldest one left
+	while (world.GetIsRun() && debugger.GetMoveCount() < 60) debugger.Step(world, UINT32_MAX);
+	Check(debugger.GetMoveCount() == 60, "played on");
+	while (debugger.StepBack(world)) {}
+	Check(debugger.GetMoveCount() == 32 && !debugger.GetIsStepBackPossible(), "stopped at the oldest snapshot");
+
+	//Skipping ahead without the debugger ends stepping back
+	debugger.Stop();
+	Check(!debugger.StepBack(world), "no step back once stopped");
+
+	return nFailed == 0 ? 0 : 1;
+}
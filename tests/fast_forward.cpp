@@ -0,0 +1,50 @@
+#include "Simulation.h"
+#include "LevelManager.h"
+#include <iostream>
+
+//Fast-forwarding skips the repeated periods of loops, it must end every run exactly where stepping it does
+//Run from the game folder so files/ is found
+int main() {
+	const std::vector<std::vector<std::string>> programs = {
+		{ "repeat 1000", "move fd", "turn rt", "end" },
+		{ "repeat 777", "repeat 3", "move fd", "end", "turn lt", "move fd", "end" },
+		{ "repeat 5000", "if fd empty", "move fd", "else", "turn rt", "endif", "end" },
+		{ "repeat 50", "repeat 37", "if fd empty", "move fd", "else", "turn lt", "end", "move bk", "end", "end" },
+		{ "repeat 20000", "move fd", "move bk", "end", "repeat 4", "move fd", "end" },
+		{ "repeat 6", "move fd", "end", "turn rt", "repeat 4", "move fd", "end" }
+	};
+
+	LevelManager levelManager;
+	if (levelManager.GetLevelCount() == 0) {
+		std::cerr << "no levels found\n";
+		return 1;
+	}
+
+	int nFailed = 0;
+	for (int level = 0; level < levelManager.GetLevelCount(); level++) {
+		levelManager.SetIndex(level);
+
+		for (std::size_t i = 0; i < programs.size(); i++) {
+			RunResult skipped = World::FastForward(levelManager.GetLevel(), levelManager.GetItemMap(), levelManager.GetOpponentPath(), programs[i]);
+
+			World world;
+			world.Load(levelManager.GetLevel(), levelManager.GetItemMap(), levelManager.GetOpponentPath());
+			world.Run(programs[i]);
+			while (world.GetIsRun()) world.Step(UINT32_MAX);
+			RunResult stepped = world.GetResult();
+
+			bool isEqual = skipped.outcome.isWin == stepped.outcome.isWin && skipped.outcome.isAborted == stepped.outcome.isAborted &&
+				skipped.outcome.nMoves == stepped.outcome.nMoves && skipped.outcome.nSteps == stepped.outcome.nSteps &&
+				skipped.playerCell == stepped.playerCell && skipped.direction == stepped.direction &&
+				skipped.boxes == stepped.boxes && skipped.toggles == stepped.toggles;
+
+			if (!isEqual) {
+				std::cerr << "level " << level << " program " << i << ": fast-forward " << skipped.outcome.nMoves
+					<< " moves, stepping " << stepped.outcome.nMoves << " moves\n";
+				nFailed++;
+			}
+		}
+	}
+
+	return nFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+#include "MoveTrace.h"
+#include <iostream>
+
+static int nFailed = 0;
+
+static void Check(bool isPassed, const char* what) {
+	if (isPassed) return;
+	std::cerr << "failed: " << what << "\n";
+	nFailed++;
+}
+
+static std::vector<uint8_t> Expand(const MoveTrace& trace) {
+	std::vector<uint8_t> moves;
+	for (uint8_t move : trace) moves.push_back(move);
+	return moves;
+}
+
+//Run-length encoding of pushed moves, truncating them & skipping repeated periods
+int main() {
+	const uint8_t a = MoveTrace::Pack(0, 0, true), b = MoveTrace::Pack(2, 1, false);
+
+	MoveTrace trace;
+	for (uint8_t move : { a, a, a, b, a, a }) trace.Push(move);
+
+	Check(trace.GetSize() == 6 && trace.GetNCounted() == 5, "pushed counts");
+	Check(trace.GetRunCount() == 3, "equal neighbours share a run");
+	Check(Expand(trace) == std::vector<uint8_t>{ a, a, a, b, a, a }, "moves read back in order");
+	Check(MoveTrace::GetMoveDirection(b) == 2 && MoveTrace::GetFacing(b) == 1 && !MoveTrace::GetIsCounted(b), "packed fields");
+
+	//Truncating inside a run shortens it, past a run drops it
+	trace.Truncate(4, 3);
+	Check(trace.GetSize() == 4 && trace.GetNCounted() == 3 && trace.GetRunCount() == 2, "truncated counts");
+	Check(Expand(trace) == std::vector<uint8_t>{ a, a, a, b }, "truncated moves");
+	trace.Truncate(2, 2);
+	Check(Expand(trace) == std::vector<uint8_t>{ a, a } && trace.GetRunCount() == 1, "truncated into the first run");
+
+	//A period of one repeated move extends the last run, splitting it where a run is full
+	const std::size_t nPeriods = 20000000;
+	trace.Skip(1, 1, nPeriods);
+	Check(trace.GetSize() == 2 + nPeriods && trace.GetNCounted() == 2 + nPeriods, "skipped counts");
+	Check(trace.GetRunCount() == 2, "long skip split into full runs");
+	Check(trace.Back() == a, "skipped move");
+
+	trace.Truncate(5, 5);
+	Check(trace.GetSize() == 5 && trace.GetRunCount() == 1, "truncated after a skip");
+
+	trace.Clear();
+	Check(trace.IsEmpty() && trace.GetRunCount() == 0 && trace.GetNCounted() == 0, "cleared");
+
+	return nFailed == 0 ? 0 : 1;
+}
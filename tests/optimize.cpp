@@ -0,0 +1,32 @@
+#include "Interpreter.h"
+#include <iostream>
+
+//Runs a program to its end with every if condition answered by isEmpty & returns the move directions it made
+static std::vector<int> Moves(const std::vector<std::string>& strings, bool isEmpty) {
+	Interpreter interpreter;
+	interpreter.Load(std::make_shared<const Program>(Program::Compile(strings)), 0);
+
+	std::vector<int> moves;
+	int direction = 0;
+	while (interpreter.Next(direction, [&](int) { return isEmpty; }) == Yield::Move) moves.push_back(direction);
+	return moves;
+}
+
+//Turns dropped or folded by the peephole passes must not take an if's jump target with them
+int main() {
+	const std::vector<std::string> strings = {
+		"turn lt", "if fd empty", "turn lt", "endif", "repeat 4", "turn rt", "end", "turn rt", "repeat 3", "move fd", "end"
+	};
+
+	int nFailed = 0;
+	if (Moves(strings, true) != std::vector<int>{ 3, 3, 3 }) {
+		std::cerr << "taken if: wrong moves\n";
+		nFailed++;
+	}
+	if (Moves(strings, false) != std::vector<int>{ 0, 0, 0 }) {
+		std::cerr << "skipped if: wrong moves\n";
+		nFailed++;
+	}
+
+	return nFailed == 0 ? 0 : 1;
+}
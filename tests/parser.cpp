@@ -0,0 +1,63 @@
+#include "Interpreter.h"
+#include <iostream>
+
+static int nFailed = 0;
+
+static void Check(bool isPassed, const char* what) {
+	if (isPassed) return;
+	std::cerr << "failed: " << what << "\n";
+	nFailed++;
+}
+
+static bool IsStatement(const Statement& statement, Statement::Type type, int arg, int line, int elseLine, int endLine) {
+	return statement.type == type && statement.arg == arg && statement.line == line &&
+		statement.elseLine == elseLine && statement.endLine == endLine;
+}
+
+//Block tree of nested loops & ifs, with the console line of every statement & closing keyword
+int main() {
+	const Block block = Parser::Parse({
+		"repeat 3",			//0
+		"  move fd",		//1
+		"  if fd empty",	//2
+		"    turn rt",		//3
+		"  else",			//4
+		"    move bk",		//5
+		"  endif",			//6
+		"end",				//7
+		"",					//8
+		"turn lt",			//9
+		"end",				//10 no loop is open, ignored
+		"jump fd",			//11 not a command, ignored
+		"loop 2",			//12 left open until the end of the program
+		"move fd"			//13
+	});
+
+	Check(block.size() == 3, "three top statements");
+	if (block.size() == 3) {
+		Check(IsStatement(block[0], Statement::Type::Repeat, 3, 0, -1, 7), "repeat with its end");
+		Check(IsStatement(block[1], Statement::Type::Turn, 3, 9, -1, -1), "turn left after the loop");
+		Check(IsStatement(block[2], Statement::Type::Repeat, 2, 12, -1, -1), "unterminated loop");
+
+		const Block& body = block[0].body;
+		Check(body.size() == 2, "loop body of two statements");
+		if (body.size() == 2) {
+			Check(IsStatement(body[0], Statement::Type::Move, 0, 1, -1, -1), "move fd in the loop");
+			Check(IsStatement(body[1], Statement::Type::If, (int)Condition::FdEmpty, 2, 4, 6), "if with else & endif");
+			Check(body[1].body.size() == 1 && IsStatement(body[1].body[0], Statement::Type::Turn, 1, 3, -1, -1), "then branch");
+			Check(body[1].elseBody.size() == 1 && IsStatement(body[1].elseBody[0], Statement::Type::Move, 2, 5, -1, -1), "else branch");
+		}
+
+		Check(block[2].body.size() == 1 && IsStatement(block[2].body[0], Statement::Type::Move, 0, 13, -1, -1), "open loop body");
+	}
+
+	//An if without a known condition always takes its first branch
+	const Block always = Parser::Parse({ "if", "move fd", "endif" });
+	Check(always.size() == 1 && IsStatement(always[0], Statement::Type::If, (int)Condition::Always, 0, -1, 2), "if without condition");
+
+	//Loop counts are clamped to what an int holds & never negative
+	const Block counts = Parser::Parse({ "repeat 99999999999", "end", "repeat -5", "end" });
+	Check(counts.size() == 2 && counts[0].arg == INT_MAX && counts[1].arg == 0, "clamped loop counts");
+
+	return nFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+#include "Replay.h"
+#include "LevelManager.h"
+#include <filesystem>
+#include <iostream>
+
+static int nFailed = 0;
+
+static void Check(bool isPassed, const char* what) {
+	if (isPassed) return;
+	std::cerr << "failed: " << what << "\n";
+	nFailed++;
+}
+
+//A recorded run saved, loaded back & verified, then checked against another level and against a changed digest
+//Run from the game folder so files/ is found
+int main() {
+	LevelManager levelManager;
+	if (levelManager.GetLevelCount() < 2) {
+		std::cerr << "no levels found\n";
+		return 1;
+	}
+	levelManager.SetIndex(0);
+
+	const std::vector<std::string> strings = { "repeat 3", "move fd", "turn rt", "end", "move bk" };
+	Replay recorded = Replay::Record(levelManager.GetLevel(), levelManager.GetItemMap(), levelManager.GetOpponentPath(), 0, strings);
+	Check(recorded.GetDigestCount() == (std::size_t)recorded.GetOutcome().nSteps, "a digest for every move");
+
+	const std::string fileName = (std::filesystem::temp_directory_path() / "replay_test.rpl").string();
+	Check(recorded.Save(fileName), "saved");
+
+	Replay loaded;
+	Check(loaded.Load(fileName), "loaded");
+	Check(loaded.GetLevelIndex() == 0 && loaded.GetStrings() == strings, "program & level read back");
+	Check(loaded.GetDigestCount() == recorded.GetDigestCount(), "digests read back");
+	Check(loaded.GetOutcome().nMoves == recorded.GetOutcome().nMoves && loaded.GetOutcome().isWin == recorded.GetOutcome().isWin, "outcome read back");
+
+	std::string message;
+	Check(loaded.Verify(levelManager.GetLevel(), levelManager.GetItemMap(), levelManager.GetOpponentPath(), message), "reproduces on its level");
+
+	levelManager.SetIndex(1);
+	Check(!loaded.Verify(levelManager.GetLevel(), levelManager.GetItemMap(), levelManager.GetOpponentPath(), message) &&
+		message.find("differs from the one recorded") != std::string::npos, "told apart from another level");
+	levelManager.SetIndex(0);
+
+	//Flipping a bit of the last digest is reported at that move
+	{
+		std::fstream file(fileName, std::ios::binary | std::ios::in | std::ios::out);
+		file.seekg(-1, std::ios::end);
+		char c = (char)file.get();
+		file.seekp(-1, std::ios::end);
+		file.put((char)(c ^ 1));
+	}
+	Check(loaded.Load(fileName), "changed file loaded");
+	Check(!loaded.Verify(levelManager.GetLevel(), levelManager.GetItemMap(), levelManager.GetOpponentPath(), message) &&
+		message == "state differs after move " + std::to_string(loaded.GetDigestCount()), "desync found at its move");
+
+	//A truncated file is not a replay
+	std::filesystem::resize_file(fileName, 20);
+	Check(!loaded.Load(fileName), "truncated file rejected");
+
+	std::filesystem::remove(fileName);
+	return nFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+#include "Synthesizer.h"
+#include "LevelManager.h"
+#include <iostream>
+#include <cstdlib>
+
+//Finds the shortest program in console lines for every campaign level, starting from the solver's witness as the bound
+//Usage: golf [--threads N] [--statement-lines N] [--max-repeat N] [--max-states N] [--program] [level index...]
+//Run from the game folder so files/ is found
+int main(int argc, char** argv) {
+	std::size_t nThreads = std::thread::hardware_concurrency(), maxStates = 1 << 13;
+	int maxStatementLines = 5, maxRepeat = 9;
+	bool isProgramPrinted = false;
+	std::vector<int> indices;
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--threads" && i + 1 < argc) nThreads = (std::size_t)std::atoi(argv[++i]);
+		else if (arg == "--statement-lines" && i + 1 < argc) maxStatementLines = std::atoi(argv[++i]);
+		else if (arg == "--max-repeat" && i + 1 < argc) maxRepeat = std::atoi(argv[++i]);
+		else if (arg == "--max-states" && i + 1 < argc) maxStates = (std::size_t)std::atoll(argv[++i]);
+		else if (arg == "--program") isProgramPrinted = true;
+		else indices.push_back(std::atoi(argv[i]));
+	}
+
+	LevelManager levelManager;
+	if (levelManager.GetLevelCount() == 0) {
+		std::cerr << "no levels found, run from the game folder\n";
+		return 2;
+	}
+
+	if (indices.empty()) {
+		for (int i = 0; i < levelManager.GetLevelCount(); i++) indices.push_back(i);
+	}
+
+	ThreadPool pool(nThreads);
+	Synthesizer synthesizer(maxStatementLines, maxRepeat);
+	std::cerr << synthesizer.GetStatementCount() << " candidate statements\n";
+
+	int result = 0;
+	for (int index : indices) {
+		if (index < 0 || index >= levelManager.GetLevelCount()) {
+			std::cerr << "level index " << index << " out of range\n";
+			return 2;
+		}
+		levelManager.SetIndex(index);
+
+		const Level& level = levelManager.GetLevel();
+		const ItemMap& itemMap = levelManager.GetItemMap();
+		std::string opponentPath = levelManager.GetOpponentPath();
+
+		Solver solver;
+		Solution solution = solver.Solve(level, itemMap, opponentPath);
+
+		Golf golf = synthesizer.Synthesize(level, itemMap, opponentPath, solution.ToProgram(), pool, maxStates);
+
+		std::cout << "level " << index << ": ";
+		if (!golf.isSolved) {
+			std::cout << "unsolvable\n";
+			result = 1;
+			continue;
+		}
+
+		RunOutcome replay = World::FastForward(level, itemMap, opponentPath, golf.program).outcome;
+		std::cout << golf.program.size() << " lines" << (golf.isExhausted ? " (best found, state limit hit)" : "") << ", "
+			<< golf.nStates << " states" << (replay.isWin ? "" : ", does not replay") << "\n";
+		if (!replay.isWin) result = 1;
+
+		if (isProgramPrinted) {
+			for (const auto& line : golf.program) std::cout << "  " << line << "\n";
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,195 @@
+#include "Simulation.h"
+#include "LevelManager.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+//Plays every program against every campaign level in parallel and prints one record per pair
+//Usage: grade [--threads N] [--format csv|json] <program directory | ->
+//A directory holds one program per file, on stdin programs are separated by lines holding ===, a line holding --- stays in its program as a player part marker
+//Run from the game folder so files/ is found
+
+struct Submission {
+	std::string name;
+	std::vector<std::string> strings;
+};
+
+static std::vector<std::string> ReadLines(std::istream& reader) {
+	std::vector<std::string> strings;
+	std::string line;
+	while (std::getline(reader, line)) strings.push_back(line);
+	return strings;
+}
+
+static bool IsSeparator(const std::string& line) {
+	Token tokens[maxTokens];
+	return Tokenize(line, tokens) == 1 && tokens[0].text == "===";
+}
+
+static std::vector<Submission> LoadDirectory(const std::string& folder) {
+	std::vector<Submission> submissions;
+
+	for (const auto& entry : std::filesystem::directory_iterator(folder)) {
+		if (!entry.is_regular_file()) continue;
+
+		std::ifstream reader(entry.path());
+		submissions.push_back({ entry.path().filename().string(), ReadLines(reader) });
+	}
+
+	std::sort(submissions.begin(), submissions.end(), [](const Submission& a, const Submission& b) {
+		return a.name < b.name;
+	});
+
+	return submissions;
+}
+
+static std::vector<Submission> LoadStream(std::istream& reader) {
+	std::vector<Submission> submissions(1);
+	std::string line;
+
+	while (std::getline(reader, line)) {
+		if (IsSeparator(line)) submissions.emplace_back();
+		else submissions.back().strings.push_back(line);
+	}
+
+	for (std::size_t i = 0; i < submissions.size(); i++) {
+		submissions[i].name = "stdin:" + std::to_string(i);
+	}
+
+	return submissions;
+}
+
+static std::string EscapeJson(const std::string& text) {
+	std::string escaped;
+	for (char c : text) {
+		switch (c) {
+		case '"': escaped += "\\\""; break;
+		case '\\': escaped += "\\\\"; break;
+		case '\n': escaped += "\\n"; break;
+		case '\r': escaped += "\\r"; break;
+		case '\t': escaped += "\\t"; break;
+		default:
+			if ((unsigned char)c < 0x20) escaped += ' ';
+			else escaped += c;
+		}
+	}
+	return escaped;
+}
+
+static std::string EscapeCsv(const std::string& text) {
+	if (text.find_first_of(",\"\n\r") == std::string::npos) return text;
+
+	std::string escaped = "\"";
+	for (char c : text) {
+		if (c == '"') escaped += '"';
+		escaped += c;
+	}
+	return escaped + "\"";
+}
+
+int main(int argc, char** argv) {
+	std::size_t nThreads = std::thread::hardware_concurrency();
+	std::string format = "csv", source;
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--threads" && i + 1 < argc) nThreads = (std::size_t)std::atoi(argv[++i]);
+		else if (arg == "--format" && i + 1 < argc) format = argv[++i];
+		else source = arg;
+	}
+
+	if (source.empty() || (format != "csv" && format != "json")) {
+		std::cerr << "usage: grade [--threads N] [--format csv|json] <program directory | ->\n";
+		return 2;
+	}
+
+	std::vector<Submission> submissions;
+	if (source == "-") {
+		submissions = LoadStream(std::cin);
+	}
+	else if (std::filesystem::is_directory(source)) {
+		submissions = LoadDirectory(source);
+	}
+	else {
+		std::cerr << source << " is not a directory\n";
+		return 2;
+	}
+
+	//Every level is loaded once & copied into each run's world
+	struct LevelEntry {
+		Level level;
+		ItemMap itemMap;
+		std::string opponentPath;
+	};
+
+	LevelManager levelManager;
+	std::vector<LevelEntry> levels;
+	for (int i = 0; i < levelManager.GetLevelCount(); i++) {
+		levelManager.SetIndex(i);
+		levels.push_back({ levelManager.GetLevel(), levelManager.GetItemMap(), levelManager.GetOpponentPath() });
+	}
+
+	if (levels.empty()) {
+		std::cerr << "no levels found, run from the game folder\n";
+		return 2;
+	}
+
+	std::vector<std::string> texts(submissions.size());
+	std::vector<uint64_t> hashes(submissions.size());
+	for (std::size_t i = 0; i < submissions.size(); i++) {
+		texts[i] = ProgramCache::Normalize(submissions[i].strings);
+		hashes[i] = ProgramCache::Hash(texts[i]);
+	}
+
+	const std::size_t nLevels = levels.size();
+	std::vector<RunOutcome> records(submissions.size() * nLevels);
+
+	auto start = std::chrono::steady_clock::now();
+
+	const World::Mode mode = World::Mode::Coop; //Multi-player levels are graded as co-op
+
+	ThreadPool pool(nThreads);
+	pool.ForEach(records.size(), [&](std::size_t i) {
+		std::size_t program = i / nLevels, levelIndex = i % nLevels;
+		RunOutcome& outcome = records[i];
+
+		//Resubmitted programs reuse the outcome of their first copy
+		if (ProgramCache::Get().FindOutcome(texts[program], hashes[program], (int)levelIndex, mode, outcome)) return;
+
+		const LevelEntry& entry = levels[levelIndex];
+		outcome = World::FastForward(entry.level, entry.itemMap, entry.opponentPath, submissions[program].strings, mode).outcome;
+		ProgramCache::Get().StoreOutcome(texts[program], hashes[program], (int)levelIndex, mode, outcome);
+	});
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	if (format == "csv") std::cout << "program,level,win,aborted,moves,steps\n";
+	else std::cout << "[\n";
+
+	for (std::size_t i = 0; i < records.size(); i++) {
+		const std::string& name = submissions[i / nLevels].name;
+		const RunOutcome& outcome = records[i];
+
+		if (format == "csv") {
+			std::cout << EscapeCsv(name) << ',' << i % nLevels << ',' << outcome.isWin << ',' << outcome.isAborted << ','
+				<< outcome.nMoves << ',' << outcome.nSteps << '\n';
+		}
+		else {
+			std::cout << "  {\"program\": \"" << EscapeJson(name) << "\", \"level\": " << i % nLevels
+				<< ", \"win\": " << (outcome.isWin ? "true" : "false") << ", \"aborted\": " << (outcome.isAborted ? "true" : "false")
+				<< ", \"moves\": " << outcome.nMoves << ", \"steps\": " << outcome.nSteps << '}'
+				<< (i + 1 < records.size() ? ",\n" : "\n");
+		}
+	}
+
+	if (format == "json") std::cout << "]\n";
+
+	std::cerr << "graded " << submissions.size() << " programs x " << nLevels << " levels on " << pool.GetSize()
+		<< " threads in " << elapsed.count() << "s\n";
+
+	return 0;
+}
@@ -0,0 +1,138 @@
+#include "Replay.h"
+#include "LevelManager.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <cstdlib>
+
+//Records runs into replay files and checks replays by playing them again without a window
+//Usage: replay record <level index> <program file | -> <replay file>
+//       replay verify [--threads N] <replay file | directory>...
+//Verify exits with 1 when a replay does not reproduce, run from the game folder so files/ is found
+
+static int Record(int argc, char** argv) {
+	if (argc < 5) {
+		std::cerr << "usage: replay record <level index> <program file | -> <replay file>\n";
+		return 2;
+	}
+
+	std::vector<std::string> strings;
+	std::string line;
+
+	if (std::string(argv[3]) == "-") {
+		while (std::getline(std::cin, line)) strings.push_back(line);
+	}
+	else {
+		std::ifstream reader(argv[3]);
+		if (!reader.is_open()) {
+			std::cerr << "cannot open " << argv[3] << "\n";
+			return 2;
+		}
+		while (std::getline(reader, line)) strings.push_back(line);
+	}
+
+	LevelManager levelManager;
+	int index = std::atoi(argv[2]);
+	if (index < 0 || index >= levelManager.GetLevelCount()) {
+		std::cerr << "level index out of range (0-" << levelManager.GetLevelCount() - 1 << ")\n";
+		return 2;
+	}
+	levelManager.SetIndex(index);
+
+	Replay replay = Replay::Record(levelManager.GetLevel(), levelManager.GetItemMap(), levelManager.GetOpponentPath(), index, strings);
+	if (!replay.Save(argv[4])) {
+		std::cerr << "cannot write " << argv[4] << "\n";
+		return 2;
+	}
+
+	const RunOutcome& outcome = replay.GetOutcome();
+	std::cout << "win " << outcome.isWin << " aborted " << outcome.isAborted << " moves " << outcome.nMoves
+		<< " steps " << outcome.nSteps << " digests " << replay.GetDigestCount() << "\n";
+
+	return 0;
+}
+
+static int Verify(int argc, char** argv) {
+	std::size_t nThreads = std::thread::hardware_concurrency();
+	std::vector<std::string> files;
+
+	for (int i = 2; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--threads" && i + 1 < argc) {
+			nThreads = (std::size_t)std::atoi(argv[++i]);
+		}
+		else if (std::filesystem::is_directory(arg)) {
+			std::vector<std::string> entries;
+			for (const auto& entry : std::filesystem::directory_iterator(arg)) {
+				if (entry.is_regular_file()) entries.push_back(entry.path().string());
+			}
+			std::sort(entries.begin(), entries.end());
+			files.insert(files.end(), entries.begin(), entries.end());
+		}
+		else {
+			files.push_back(arg);
+		}
+	}
+
+	if (files.empty()) {
+		std::cerr << "usage: replay verify [--threads N] <replay file | directory>...\n";
+		return 2;
+	}
+
+	//Every level is loaded once & shared by the checks
+	struct LevelEntry {
+		Level level;
+		ItemMap itemMap;
+		std::string opponentPath;
+	};
+
+	LevelManager levelManager;
+	std::vector<LevelEntry> levels;
+	for (int i = 0; i < levelManager.GetLevelCount(); i++) {
+		levelManager.SetIndex(i);
+		levels.push_back({ levelManager.GetLevel(), levelManager.GetItemMap(), levelManager.GetOpponentPath() });
+	}
+
+	std::vector<std::string> messages(files.size());
+	std::vector<char> isValid(files.size(), 0);
+
+	ThreadPool pool(nThreads);
+	pool.ForEach(files.size(), [&](std::size_t i) {
+		Replay replay;
+		if (!replay.Load(files[i])) {
+			messages[i] = "not a replay file";
+			return;
+		}
+
+		if (replay.GetLevelIndex() >= (int)levels.size()) {
+			messages[i] = "level " + std::to_string(replay.GetLevelIndex()) + " does not exist";
+			return;
+		}
+
+		const LevelEntry& entry = levels[replay.GetLevelIndex()];
+		isValid[i] = replay.Verify(entry.level, entry.itemMap, entry.opponentPath, messages[i]);
+	});
+
+	std::size_t nFailed = 0;
+	for (std::size_t i = 0; i < files.size(); i++) {
+		std::cout << files[i] << ": " << messages[i] << "\n";
+		if (!isValid[i]) nFailed++;
+	}
+
+	std::cerr << files.size() - nFailed << " of " << files.size() << " replays reproduce\n";
+
+	return nFailed > 0 ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+	std::string mode = argc > 1 ? argv[1] : "";
+
+	if (mode == "record") return Record(argc, argv);
+	if (mode == "verify") return Verify(argc, argv);
+
+	std::cerr << "usage: replay record <level index> <program file | -> <replay file>\n"
+		<< "       replay verify [--threads N] <replay file | directory>...\n";
+	return 2;
+}
@@ -0,0 +1,74 @@
+#include "Simulation.h"
+#include "LevelManager.h"
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+
+//Plays a program on a campaign level without a window and prints the outcome
+//Usage: simulate [--race] <level index> <program file | ->, run from the game folder so files/ is found
+//On a level with several players each one also gets a line with its own cell, moves & win
+int main(int argc, char** argv) {
+	World::Mode mode = World::Mode::Coop;
+	if (argc > 1 && std::string(argv[1]) == "--race") {
+		mode = World::Mode::Race;
+		argv++;
+		argc--;
+	}
+
+	if (argc < 3) {
+		std::cerr << "usage: simulate [--race] <level index> <program file | ->\n";
+		return 2;
+	}
+
+	std::vector<std::string> strings;
+	std::string line;
+
+	if (std::string(argv[2]) == "-") {
+		while (std::getline(std::cin, line)) strings.push_back(line);
+	}
+	else {
+		std::ifstream reader(argv[2]);
+		if (!reader.is_open()) {
+			std::cerr << "cannot open " << argv[2] << "\n";
+			return 2;
+		}
+		while (std::getline(reader, line)) strings.push_back(line);
+	}
+
+	LevelManager levelManager;
+	int index = std::atoi(argv[1]);
+	if (index < 0 || index >= levelManager.GetLevelCount()) {
+		std::cerr << "level index out of range (0-" << levelManager.GetLevelCount() - 1 << ")\n";
+		return 2;
+	}
+	levelManager.SetIndex(index);
+
+	World world;
+	world.SetMode(mode);
+	world.Load(levelManager.GetLevel(), levelManager.GetItemMap(), levelManager.GetOpponentPath());
+	world.Run(strings);
+	world.FastForward();
+
+	RunResult result = world.GetResult();
+
+	std::cout << "win " << result.outcome.isWin
+		<< " aborted " << result.outcome.isAborted
+		<< " moves " << result.outcome.nMoves
+		<< " steps " << result.outcome.nSteps
+		<< " pos " << result.playerCell.x << "," << result.playerCell.y
+		<< " dir " << result.direction << "\n";
+
+	const std::vector<Player>& players = world.GetPlayers();
+	if (players.size() > 1) {
+		for (std::size_t i = 0; i < players.size(); i++) {
+			std::cout << "player " << i
+				<< " win " << players[i].GetIsWin()
+				<< " moves " << players[i].GetNMoves()
+				<< " pos " << players[i].GetPosition().x << "," << players[i].GetPosition().y
+				<< " dir " << players[i].GetDirection() << "\n";
+		}
+		if (mode == World::Mode::Race) std::cout << "winner " << world.GetWinner() << "\n";
+	}
+
+	return 0;
+}
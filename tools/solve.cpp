@@ -0,0 +1,88 @@
+#include "Solver.h"
+#include "LevelManager.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <cstdlib>
+
+//Finds the par score of every campaign level & checks each witness by playing it as a program
+//Usage: solve [--threads N] [--max-states N] [--program] [level index...]
+//Exits with 1 when a level has no solution, so edits that break a level are caught
+//Run from the game folder so files/ is found
+int main(int argc, char** argv) {
+	std::size_t nThreads = std::thread::hardware_concurrency(), maxStates = 1 << 22;
+	bool isProgramPrinted = false;
+	std::vector<int> indices;
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--threads" && i + 1 < argc) nThreads = (std::size_t)std::atoi(argv[++i]);
+		else if (arg == "--max-states" && i + 1 < argc) maxStates = (std::size_t)std::atoll(argv[++i]);
+		else if (arg == "--program") isProgramPrinted = true;
+		else indices.push_back(std::atoi(argv[i]));
+	}
+
+	LevelManager levelManager;
+	if (levelManager.GetLevelCount() == 0) {
+		std::cerr << "no levels found, run from the game folder\n";
+		return 2;
+	}
+
+	if (indices.empty()) {
+		for (int i = 0; i < levelManager.GetLevelCount(); i++) indices.push_back(i);
+	}
+
+	struct Job {
+		Level level;
+		ItemMap itemMap;
+		std::string opponentPath;
+		Solution solution;
+		RunOutcome replay;
+	};
+
+	std::vector<Job> jobs;
+	for (int index : indices) {
+		if (index < 0 || index >= levelManager.GetLevelCount()) {
+			std::cerr << "level index " << index << " out of range\n";
+			return 2;
+		}
+		levelManager.SetIndex(index);
+		jobs.push_back({ levelManager.GetLevel(), levelManager.GetItemMap(), levelManager.GetOpponentPath(), {}, {} });
+	}
+
+	ThreadPool pool(nThreads);
+	pool.ForEach(jobs.size(), [&](std::size_t i) {
+		Job& job = jobs[i];
+
+		Solver solver;
+		job.solution = solver.Solve(job.level, job.itemMap, job.opponentPath, maxStates);
+
+		if (job.solution.isSolved) {
+			job.replay = World::FastForward(job.level, job.itemMap, job.opponentPath, job.solution.ToProgram()).outcome;
+		}
+	});
+
+	int result = 0;
+	for (std::size_t i = 0; i < jobs.size(); i++) {
+		const Solution& solution = jobs[i].solution;
+		std::cout << "level " << indices[i] << ": ";
+
+		if (!solution.isSolved) {
+			std::cout << (solution.isExhausted ? "gave up" : "unsolvable") << " after " << solution.nStates << " states\n";
+			result = 1;
+			continue;
+		}
+
+		const RunOutcome& replay = jobs[i].replay;
+		bool isVerified = replay.isWin && replay.nMoves == solution.nMoves;
+
+		std::cout << "par " << solution.nMoves << ", " << solution.moves.size() << " steps, " << solution.nStates << " states"
+			<< (isVerified ? "" : ", witness does not replay") << "\n";
+		if (!isVerified) result = 1;
+
+		if (isProgramPrinted) {
+			for (const auto& line : solution.ToProgram()) std::cout << "  " << line << "\n";
+		}
+	}
+
+	return result;
+}